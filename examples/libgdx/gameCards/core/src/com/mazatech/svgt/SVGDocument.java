@@ -38,11 +38,14 @@ package com.mazatech.svgt;
 
 public class SVGDocument {
 
-    SVGDocument(int handle) {
+    SVGDocument(int handle, String xmlText) {
 
         float[] viewport = new float[4];
 
         _doc = new SVGTHandle(handle);
+        // keep a reference to the source only if the document must be clonable (strings are
+        // immutable, so clones share it); otherwise the text can be collected right away
+        _xmlText = xmlText;
         // get document viewport
         if (AmanithSVG.svgtDocViewportGet(_doc, viewport) == SVGTError.None) {
             _viewport = new SVGViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
@@ -98,6 +101,114 @@ public class SVGDocument {
         return result;
     }
 
+    /*
+        Map an array of points (interleaved x, y pairs) from the document viewport system into the surface
+        viewport (inverse = false), or from the surface viewport into the document viewport system (inverse = true).
+        The combined viewport transformation is calculated once per call, so mapping many points costs three
+        native calls in total; 'src' and 'dst' can be the same array.
+    */
+    public SVGTError pointMapBatch(SVGSurface surface, float[] src, float[] dst, int count, boolean inverse) {
+
+        SVGTError err;
+
+        if (surface == null) {
+            throw new IllegalArgumentException("surface == null");
+        }
+        else
+        if ((src == null) || (src.length < (count * 2))) {
+            throw new IllegalArgumentException("src == null or too small");
+        }
+        else
+        if ((dst == null) || (dst.length < (count * 2))) {
+            throw new IllegalArgumentException("dst == null or too small");
+        }
+        else {
+            float[] m = new float[6];
+            // calculate the combined viewport transformation
+            if ((err = pointMapMatrix(surface, inverse, m)) == SVGTError.None) {
+                // transform the whole array
+                for (int i = 0; i < (count * 2); i += 2) {
+                    float x = src[i];
+                    float y = src[i + 1];
+                    dst[i] = (m[0] * x) + (m[2] * y) + m[4];
+                    dst[i + 1] = (m[1] * x) + (m[3] * y) + m[5];
+                }
+            }
+        }
+
+        return err;
+    }
+
+    /*
+        Calculate the affine matrix (a, b, c, d, tx, ty) that maps document points into surface points, or vice versa.
+        The matrix is built from the viewports in double precision: sampling svgtPointMap and differencing the results
+        would lose all precision when the document viewport origin is far from zero.
+    */
+    private SVGTError pointMapMatrix(SVGSurface surface, boolean inverse, float[] m) {
+
+        SVGTError err;
+
+        // update document viewport (AmanithSVG backend)
+        if ((err = updateViewport()) == SVGTError.None) {
+            // update surface viewport (AmanithSVG backend)
+            if ((err = surface.updateViewport()) == SVGTError.None) {
+                float[] docViewport = new float[4];
+                float[] surfaceViewport = new float[4];
+                int[] alignment;
+
+                if (((err = AmanithSVG.svgtDocViewportGet(_doc, docViewport)) == SVGTError.None) &&
+                    ((err = AmanithSVG.svgtSurfaceViewportGet(surface.getHandle(), surfaceViewport)) == SVGTError.None)) {
+                    if ((alignment = AmanithSVG.svgtDocViewportAlignmentGet(_doc)) == null) {
+                        err = SVGTError.IllegalArgument;
+                    }
+                    else
+                    if ((docViewport[2] <= 0.0f) || (docViewport[3] <= 0.0f) || (surfaceViewport[2] <= 0.0f) || (surfaceViewport[3] <= 0.0f)) {
+                        // degenerate viewport
+                        err = SVGTError.IllegalArgument;
+                    }
+                    else {
+                        double sx = (double)surfaceViewport[2] / (double)docViewport[2];
+                        double sy = (double)surfaceViewport[3] / (double)docViewport[3];
+                        double offsetX = 0.0;
+                        double offsetY = 0.0;
+                        double tx, ty;
+
+                        if (alignment[0] != AmanithSVGJNI.SVGT_ASPECT_RATIO_ALIGN_NONE) {
+                            // uniform scale; alignments are ordered as xMin, xMid, xMax within yMin, yMid, yMax
+                            double s = (alignment[1] == AmanithSVGJNI.SVGT_ASPECT_RATIO_SLICE) ? Math.max(sx, sy) : Math.min(sx, sy);
+                            double alignX = ((alignment[0] - 1) % 3) * 0.5;
+                            double alignY = ((alignment[0] - 1) / 3) * 0.5;
+                            offsetX = ((double)surfaceViewport[2] - ((double)docViewport[2] * s)) * alignX;
+                            offsetY = ((double)surfaceViewport[3] - ((double)docViewport[3] * s)) * alignY;
+                            sx = s;
+                            sy = s;
+                        }
+                        // the document viewport origin is mapped onto the (aligned) surface viewport origin
+                        tx = (double)surfaceViewport[0] + offsetX - ((double)docViewport[0] * sx);
+                        ty = (double)surfaceViewport[1] + offsetY - ((double)docViewport[1] * sy);
+
+                        m[1] = 0.0f;
+                        m[2] = 0.0f;
+                        if (inverse) {
+                            m[0] = (float)(1.0 / sx);
+                            m[3] = (float)(1.0 / sy);
+                            m[4] = (float)(-tx / sx);
+                            m[5] = (float)(-ty / sy);
+                        }
+                        else {
+                            m[0] = (float)sx;
+                            m[3] = (float)sy;
+                            m[4] = (float)tx;
+                            m[5] = (float)ty;
+                        }
+                    }
+                }
+            }
+        }
+
+        return err;
+    }
+
 
     // AmanithSVG document handle (read only).
     public SVGTHandle getHandle() {
@@ -211,8 +322,22 @@ public class SVGDocument {
         return err;
     }
 
+    // True if the document has been created as clonable (i.e. it retains its source XML text), see SVGAssets.cloneDocument.
+    public boolean isClonable() {
+
+        return (_xmlText != null);
+    }
+
+    // Source XML text (retained for clonable documents only, null otherwise).
+    String getXmlText() {
+
+        return _xmlText;
+    }
+
     // Document native handle.
     private SVGTHandle _doc;
+    // Source XML text (null if the document is not clonable).
+    private final String _xmlText;
     // Viewport.
     private SVGViewport _viewport = null;
     // Viewport aspect ratio/alignment.
@@ -0,0 +1,238 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file allocator.c
+    \brief Pluggable memory allocator, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "allocator.h"
+#include <stdlib.h>
+#include <string.h>
+
+// C runtime callbacks
+static void* runtimeMalloc(size_t size,
+                           void* userData) {
+
+    (void)userData;
+    return malloc(size);
+}
+
+static void* runtimeRealloc(void* ptr,
+                            size_t size,
+                            void* userData) {
+
+    (void)userData;
+    return realloc(ptr, size);
+}
+
+static void runtimeFree(void* ptr,
+                        void* userData) {
+
+    (void)userData;
+    free(ptr);
+}
+
+// the allocator currently in use
+static MemAllocator memAllocator = { runtimeMalloc, runtimeRealloc, runtimeFree, NULL };
+// memory statistics
+static MemStats memStats = { 0U, 0U, 0U, 0U, 0U };
+// heap memory limit, in bytes (0 means no limit)
+static size_t memLimit = 0U;
+
+// each block is prefixed by an header that keeps track of its size; the union ensures that
+// the user pointer has the same alignment guaranteed by the C runtime
+typedef union {
+    size_t size;
+    long double ld;
+    void* ptr;
+} MemHeader;
+
+// update statistics after an allocation of 'size' bytes
+static void memStatsAllocated(const size_t size) {
+
+    memStats.currentBytes += size;
+    memStats.liveBlocks++;
+    memStats.allocationsCount++;
+    if (memStats.currentBytes > memStats.peakBytes) {
+        memStats.peakBytes = memStats.currentBytes;
+    }
+}
+
+// update statistics after the release of 'size' bytes
+static void memStatsReleased(const size_t size) {
+
+    memStats.currentBytes -= size;
+    memStats.liveBlocks--;
+}
+
+// route all memory allocations through the given callbacks (NULL restores the C runtime ones)
+SVGTErrorCode memAllocatorSet(const MemAllocator* allocator) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    if (allocator == NULL) {
+        memAllocator.malloc = runtimeMalloc;
+        memAllocator.realloc = runtimeRealloc;
+        memAllocator.free = runtimeFree;
+        memAllocator.userData = NULL;
+    }
+    else
+    if ((allocator->malloc == NULL) || (allocator->realloc == NULL) || (allocator->free == NULL)) {
+        err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+    }
+    else {
+        memAllocator = *allocator;
+    }
+
+    return err;
+}
+
+// set a hard limit on the heap memory, in bytes (0 means no limit)
+void memLimitSet(size_t limit) {
+
+    memLimit = limit;
+}
+
+// check if 'size' additional bytes fit within the memory limit
+SVGTboolean memLimitFits(size_t size) {
+
+    return ((memLimit == 0U) || ((size <= memLimit) && (memStats.currentBytes <= (memLimit - size)))) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// allocate a memory block
+void* memMalloc(size_t size) {
+
+    void* ptr = NULL;
+
+    if (!memLimitFits(size)) {
+        memStats.refusedCount++;
+    }
+    else
+    // check for overflow
+    if (size <= (((size_t)-1) - sizeof(MemHeader))) {
+        MemHeader* header = (MemHeader*)memAllocator.malloc(sizeof(MemHeader) + size, memAllocator.userData);
+        if (header != NULL) {
+            header->size = size;
+            memStatsAllocated(size);
+            ptr = (void*)(header + 1);
+        }
+    }
+
+    return ptr;
+}
+
+// allocate a zero-initialized memory block
+void* memCalloc(size_t count,
+                size_t size) {
+
+    void* ptr = NULL;
+
+    // check for multiplication overflow
+    if ((size == 0U) || (count <= (((size_t)-1) / size))) {
+        if ((ptr = memMalloc(count * size)) != NULL) {
+            (void)memset(ptr, 0, count * size);
+        }
+    }
+
+    return ptr;
+}
+
+// resize a memory block
+void* memRealloc(void* ptr,
+                 size_t size) {
+
+    void* newPtr = NULL;
+
+    if (ptr == NULL) {
+        newPtr = memMalloc(size);
+    }
+    else {
+        MemHeader* header = ((MemHeader*)ptr) - 1;
+        const size_t oldSize = header->size;
+
+        // only the growth is checked against the memory limit
+        if ((size > oldSize) && (!memLimitFits(size - oldSize))) {
+            memStats.refusedCount++;
+        }
+        else
+        // check for overflow
+        if (size <= (((size_t)-1) - sizeof(MemHeader))) {
+            MemHeader* newHeader = (MemHeader*)memAllocator.realloc(header, sizeof(MemHeader) + size, memAllocator.userData);
+            // in case of failure, the original block is left untouched
+            if (newHeader != NULL) {
+                newHeader->size = size;
+                memStatsReleased(oldSize);
+                memStatsAllocated(size);
+                newPtr = (void*)(newHeader + 1);
+            }
+        }
+    }
+
+    return newPtr;
+}
+
+// release a memory block
+void memFree(void* ptr) {
+
+    if (ptr != NULL) {
+        MemHeader* header = ((MemHeader*)ptr) - 1;
+        memStatsReleased(header->size);
+        memAllocator.free(header, memAllocator.userData);
+    }
+}
+
+// account for 'size' bytes allocated outside of this module
+void memExternalAcquired(size_t size) {
+
+    memStatsAllocated(size);
+}
+
+// account for the release of 'size' bytes previously passed to memExternalAcquired
+void memExternalReleased(size_t size) {
+
+    memStatsReleased(size);
+}
+
+// get memory statistics
+void memStatsGet(MemStats* stats) {
+
+    *stats = memStats;
+}
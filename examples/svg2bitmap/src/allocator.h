@@ -0,0 +1,122 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+/*!
+    \file allocator.h
+    \brief Pluggable memory allocator, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include <SVGT/svgt.h>
+#include <stddef.h>
+
+/************************************************************
+                      Memory allocator
+************************************************************/
+// allocation callbacks; 'userData' is the pointer specified within the MemAllocator structure
+typedef void* (*MemMallocFunc)(size_t size,
+                               void* userData);
+typedef void* (*MemReallocFunc)(void* ptr,
+                                size_t size,
+                                void* userData);
+typedef void (*MemFreeFunc)(void* ptr,
+                            void* userData);
+
+typedef struct {
+    MemMallocFunc malloc;
+    MemReallocFunc realloc;
+    MemFreeFunc free;
+    void* userData;
+} MemAllocator;
+
+// memory statistics, covering all the blocks allocated through the functions below
+typedef struct {
+    // bytes currently allocated (headers excluded), external blocks (see memExternalAcquired) included
+    size_t currentBytes;
+    // maximum value reached by 'currentBytes'
+    size_t peakBytes;
+    // number of blocks currently allocated
+    size_t liveBlocks;
+    // total number of allocations performed (reallocations included)
+    size_t allocationsCount;
+    // number of allocations refused because they would have exceeded the memory limit
+    size_t refusedCount;
+} MemStats;
+
+// route all memory allocations through the given callbacks (NULL restores the C runtime ones); the
+// allocator must be set before any other function of the tool is called (i.e. when no memory block
+// has been allocated yet), because blocks can not be released through an allocator other than the
+// one that provided them; statistics and the limit are kept by this module, on top of the callbacks
+SVGTErrorCode memAllocatorSet(const MemAllocator* allocator);
+
+// set a hard limit on the heap memory, in bytes (0 means no limit); allocations that would exceed it
+// fail (i.e. they return NULL), so that callers report an out of memory error
+void memLimitSet(size_t limit);
+
+// check if 'size' additional bytes (e.g. a drawing surface allocated by AmanithSVG) fit within the memory limit
+SVGTboolean memLimitFits(size_t size);
+
+// allocate a memory block
+void* memMalloc(size_t size);
+
+// allocate a zero-initialized memory block, for an array of 'count' elements of 'size' bytes each
+void* memCalloc(size_t count,
+                size_t size);
+
+// resize a memory block; if 'ptr' is NULL it behaves like memMalloc
+void* memRealloc(void* ptr,
+                 size_t size);
+
+// release a memory block; NULL pointers are allowed
+void memFree(void* ptr);
+
+// account for 'size' bytes allocated outside of this module (e.g. a drawing surface allocated by
+// AmanithSVG), so that they count towards current/peak bytes and the memory limit
+void memExternalAcquired(size_t size);
+
+// account for the release of 'size' bytes previously passed to memExternalAcquired
+void memExternalReleased(size_t size);
+
+// get memory statistics; it is a plain copy of counters, so it can be polled at will
+void memStatsGet(MemStats* stats);
+
+#endif /* ALLOCATOR_H */
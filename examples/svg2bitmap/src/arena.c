@@ -0,0 +1,134 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file arena.c
+    \brief Bump (arena) allocator, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "arena.h"
+
+// alignment of arena allocations
+#define ARENA_ALIGNMENT sizeof(void*)
+// block header size, rounded up to the alignment
+#define ARENA_HEADER_SIZE (((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1U) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT)
+
+// initialize an empty arena
+void arenaInit(Arena* arena,
+               const size_t blockSize) {
+
+    arena->blocks = NULL;
+    arena->blockSize = (blockSize > 0U) ? blockSize : ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+// allocate 'size' bytes (aligned to pointer size)
+void* arenaAlloc(Arena* arena,
+                 const size_t size) {
+
+    void* result = NULL;
+    const size_t alignedSize = ((size + ARENA_ALIGNMENT - 1U) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT;
+    ArenaBlock* block = arena->blocks;
+
+    if ((block == NULL) || ((block->used + alignedSize) > block->capacity)) {
+
+        // oversized requests get a dedicated block
+        const size_t capacity = MAX(arena->blockSize, alignedSize);
+
+        if ((block = memMalloc(ARENA_HEADER_SIZE + capacity)) != NULL) {
+            block->capacity = capacity;
+            block->used = 0U;
+            // keep the current block at the head, if it has more free room than the new one
+            if ((arena->blocks != NULL) && ((capacity - alignedSize) < (arena->blocks->capacity - arena->blocks->used))) {
+                block->next = arena->blocks->next;
+                arena->blocks->next = block;
+            }
+            else {
+                block->next = arena->blocks;
+                arena->blocks = block;
+            }
+        }
+    }
+
+    if (block != NULL) {
+        result = (SVGTubyte*)block + ARENA_HEADER_SIZE + block->used;
+        block->used += alignedSize;
+    }
+
+    return result;
+}
+
+// make a copy of the given string within the arena
+char* arenaStrClone(Arena* arena,
+                    const char* str) {
+
+    char* result = NULL;
+
+    if (str != NULL) {
+        const size_t len = strlen(str) + 1U;
+        if ((result = arenaAlloc(arena, len)) != NULL) {
+            (void)memcpy(result, str, len);
+        }
+    }
+
+    return result;
+}
+
+// get the amount of memory owned by the arena, in bytes
+size_t arenaMemoryUsage(const Arena* arena) {
+
+    size_t result = 0U;
+    const ArenaBlock* block;
+
+    for (block = arena->blocks; block != NULL; block = block->next) {
+        result += ARENA_HEADER_SIZE + block->capacity;
+    }
+
+    return result;
+}
+
+// release all blocks of the given arena
+void arenaDestroy(Arena* arena) {
+
+    while (arena->blocks != NULL) {
+        ArenaBlock* next = arena->blocks->next;
+        memFree(arena->blocks);
+        arena->blocks = next;
+    }
+}
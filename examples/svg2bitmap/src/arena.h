@@ -0,0 +1,89 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/*!
+    \file arena.h
+    \brief Bump (arena) allocator, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// default size of arena blocks, in bytes
+#define ARENA_DEFAULT_BLOCK_SIZE 16384U
+
+// a memory block owned by an arena
+typedef struct ArenaBlock {
+    // next (i.e. older) block
+    struct ArenaBlock* next;
+    // block capacity and used bytes (header excluded)
+    size_t capacity;
+    size_t used;
+} ArenaBlock;
+
+// a bump allocator: allocations are carved out of large blocks, and they are all released at once
+typedef struct {
+    // the current block, at the head of the list
+    ArenaBlock* blocks;
+    // size of newly allocated blocks
+    size_t blockSize;
+} Arena;
+
+// initialize an empty arena; no memory is allocated until the first arenaAlloc call
+void arenaInit(Arena* arena,
+               const size_t blockSize);
+
+// allocate 'size' bytes (aligned to pointer size); NULL is returned in case of out of memory
+void* arenaAlloc(Arena* arena,
+                 const size_t size);
+
+// make a copy of the given string within the arena
+char* arenaStrClone(Arena* arena,
+                    const char* str);
+
+// get the amount of memory owned by the arena, in bytes (blocks headers included)
+size_t arenaMemoryUsage(const Arena* arena);
+
+// release all blocks of the given arena, invalidating all the allocations performed on it
+void arenaDestroy(Arena* arena);
+
+#endif /* ARENA_H */
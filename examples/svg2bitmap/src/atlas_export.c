@@ -467,7 +467,7 @@ static SVGTboolean atlasPageExportXML(const AtlasPage* page,
     ok = atlasWriteBuffer(args->atlasFormat, xml, args->outputDir.path, outputName.name);
 
     // we have finished
-    free(xml);
+    memFree(xml);
     xml_doc_free(&doc);
     return ok;
 }
@@ -644,7 +644,7 @@ static SVGTboolean atlasMapXML(const AtlasExporter* exporter,
     ok = atlasWriteBuffer(args->atlasFormat, xml, args->outputDir.path, map.name);
 
     // we have finished
-    free(xml);
+    memFree(xml);
     xml_doc_free(&doc);
     return ok;
 }
@@ -1684,7 +1684,7 @@ SVGTboolean atlasExport(const AtlasExporter* exporter,
 
         if ((ok = (bufferSize > 0U))) {
             // allocate output buffer
-            char* buffer = calloc(bufferSize, sizeof(char));
+            char* buffer = memCalloc(bufferSize, sizeof(char));
             if ((ok = (buffer != NULL))) {
                 switch (args->atlasFormat) {
                     // JSON based
@@ -1714,7 +1714,7 @@ SVGTboolean atlasExport(const AtlasExporter* exporter,
                         break;
                 }
                 // release temporary buffer
-                free(buffer);
+                memFree(buffer);
             }
         }
     }
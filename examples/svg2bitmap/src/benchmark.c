@@ -0,0 +1,264 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file benchmark.c
+    \brief SVG parsing benchmark, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "benchmark.h"
+#include "doc_elements.h"
+#include "gzip_utils.h"
+#include "rendering.h"
+#include "timer.h"
+
+// timings of a single benchmark phase, in nanoseconds
+typedef struct {
+    uint64_t total;
+    uint64_t min;
+} PhaseTimings;
+
+static void phaseTimingsAdd(PhaseTimings* timings,
+                            const uint64_t t) {
+
+    timings->total += t;
+    if (t < timings->min) {
+        timings->min = t;
+    }
+}
+
+// throughput of a phase over the given amount of bytes, in MB/s (based on the average time)
+static double phaseThroughput(const PhaseTimings* timings,
+                              const SVGTuint iterations,
+                              const size_t bytes) {
+
+    const double avgSec = ((double)timings->total / (double)iterations) / 1000000000.0;
+
+    return (avgSec > 0.0) ? (((double)bytes / (1024.0 * 1024.0)) / avgSec) : 0.0;
+}
+
+// print average and minimum time of a phase, in milliseconds
+static void phaseTimingsLog(const char* phaseName,
+                            const PhaseTimings* timings,
+                            const SVGTuint iterations,
+                            const CommandArguments* args) {
+
+    const double avgMs = ((double)timings->total / (double)iterations) / 1000000.0;
+    const double minMs = (double)timings->min / 1000000.0;
+
+    LOG_INFO_EXT("    %-11s avg %10.4f ms, min %10.4f ms\n", phaseName, avgMs, minMs);
+}
+
+// copy the ids of the given elements twice, within an arena (as docElementsBuild does) and with a heap
+// allocation for each one, releasing the copies; the two ways are timed separately, so that they can be compared
+static SVGTErrorCode idsCloneTimings(const DocElements* elems,
+                                     PhaseTimings* arenaTimings,
+                                     PhaseTimings* heapTimings) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    // room for the heap copies, allocated out of the timed sections
+    char** copies = memMalloc(MAX(elems->elements.size, 1U) * sizeof(char*));
+
+    if (copies != NULL) {
+
+        Arena arena;
+        size_t count = 0U;
+        uint64_t t0, t1, t2;
+
+        t0 = timerNowNs();
+        // arena: one allocation every ARENA_DEFAULT_BLOCK_SIZE bytes, a single release
+        arenaInit(&arena, ARENA_DEFAULT_BLOCK_SIZE);
+        for (size_t i = 0U; (i < elems->elements.size) && (err == SVGT_NO_ERROR); ++i) {
+            if ((elems->elements.data[i].id != NULL) && (arenaStrClone(&arena, elems->elements.data[i].id) == NULL)) {
+                err = SVGT_OUT_OF_MEMORY_ERROR;
+            }
+        }
+        arenaDestroy(&arena);
+        t1 = timerNowNs();
+
+        // heap: an allocation and a release for each id
+        for (size_t i = 0U; (i < elems->elements.size) && (err == SVGT_NO_ERROR); ++i) {
+            if (elems->elements.data[i].id != NULL) {
+
+                const size_t len = strlen(elems->elements.data[i].id) + 1U;
+
+                if ((copies[count] = memMalloc(len)) != NULL) {
+                    (void)memcpy(copies[count++], elems->elements.data[i].id, len);
+                }
+                else {
+                    err = SVGT_OUT_OF_MEMORY_ERROR;
+                }
+            }
+        }
+        for (size_t i = 0U; i < count; ++i) {
+            memFree(copies[i]);
+        }
+        t2 = timerNowNs();
+
+        phaseTimingsAdd(arenaTimings, t1 - t0);
+        phaseTimingsAdd(heapTimings, t2 - t1);
+        memFree(copies);
+    }
+    else {
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    return err;
+}
+
+// parse and destroy the given SVG file 'args->benchmarkIterations' times
+static SVGTboolean svgBenchmark(const char* fileName,
+                                const CommandArguments* args) {
+
+    size_t fileSize;
+    SVGTErrorCode loadErr;
+    SVGTboolean ok = SVGT_FALSE;
+    // add a trailing '\0'
+    char* xml = (char*)loadFileInflated(fileName, 1U, &fileSize, &loadErr);
+
+    if (xml != NULL) {
+
+        SVGTuint i;
+        SVGTErrorCode err = SVGT_NO_ERROR;
+        PhaseTimings scan = { 0U, UINT64_MAX };
+        PhaseTimings parse = { 0U, UINT64_MAX };
+        PhaseTimings index = { 0U, UINT64_MAX };
+        PhaseTimings destroy = { 0U, UINT64_MAX };
+        PhaseTimings idsArena = { 0U, UINT64_MAX };
+        PhaseTimings idsHeap = { 0U, UINT64_MAX };
+
+        for (i = 0U; (i < args->benchmarkIterations) && (err == SVGT_NO_ERROR); ++i) {
+
+            SvgScanStats stats;
+            SVGTHandle svgDoc;
+            uint64_t t0, t1;
+            // lightweight scan of the text (the same pass used for statistics and complexity limits)
+            const uint64_t ts = timerNowNs();
+            const SVGTErrorCode scanErr = svgScan(xml, &stats);
+
+            t0 = timerNowNs();
+            // parse the document
+            svgDoc = svgtDocCreate(xml);
+            t1 = timerNowNs();
+
+            if (scanErr != SVGT_NO_ERROR) {
+                err = scanErr;
+                if (svgDoc != SVGT_INVALID_HANDLE) {
+                    (void)svgtDocDestroy(svgDoc);
+                }
+            }
+            else
+            if (svgDoc != SVGT_INVALID_HANDLE) {
+
+                DocElements elems;
+                uint64_t t2, t3, t4;
+
+                // build the first-level elements index (ids are allocated from a per-document arena)
+                err = docElementsBuild(&elems, svgDoc);
+                t2 = timerNowNs();
+                // compare the ids arena against a heap allocation for each id
+                if (err == SVGT_NO_ERROR) {
+                    err = idsCloneTimings(&elems, &idsArena, &idsHeap);
+                }
+                t3 = timerNowNs();
+                // release everything
+                docElementsDestroy(&elems);
+                (void)svgtDocDestroy(svgDoc);
+                t4 = timerNowNs();
+
+                phaseTimingsAdd(&scan, t0 - ts);
+                phaseTimingsAdd(&parse, t1 - t0);
+                phaseTimingsAdd(&index, t2 - t1);
+                phaseTimingsAdd(&destroy, t4 - t3);
+            }
+            else {
+                err = svgtGetLastError();
+            }
+        }
+
+        if (err == SVGT_NO_ERROR) {
+            LOG_INFO_EXT("- %s (%u bytes, %u iterations)\n", fileName, (SVGTuint)fileSize, args->benchmarkIterations);
+            phaseTimingsLog("scan", &scan, args->benchmarkIterations, args);
+            phaseTimingsLog("parse", &parse, args->benchmarkIterations, args);
+            phaseTimingsLog("index", &index, args->benchmarkIterations, args);
+            phaseTimingsLog("destroy", &destroy, args->benchmarkIterations, args);
+            phaseTimingsLog("ids (arena)", &idsArena, args->benchmarkIterations, args);
+            phaseTimingsLog("ids (heap)", &idsHeap, args->benchmarkIterations, args);
+            LOG_INFO_EXT("    scanning throughput %.2f MB/s\n", phaseThroughput(&scan, args->benchmarkIterations, fileSize));
+            LOG_INFO_EXT("    parsing throughput %.2f MB/s\n", phaseThroughput(&parse, args->benchmarkIterations, fileSize));
+            ok = SVGT_TRUE;
+        }
+        else {
+            LOG_ERROR_EXT("- benchmark of %s failed (error code = %d)\n", fileName, err);
+        }
+
+        memFree(xml);
+    }
+    else {
+        if (loadErr == GZIP_MULTI_MEMBER_ERROR) {
+            LOG_ERROR_EXT("- %s contains multiple gzip members (concatenated streams), that are not supported\n", fileName);
+        }
+        else {
+            LOG_ERROR_EXT("- failed to load %s (error code = %d)\n", fileName, loadErr);
+        }
+    }
+
+    return ok;
+}
+
+SVGTboolean svg2BitmapBenchmark(const CommandArguments* args) {
+
+    SVGTboolean ok;
+    FileSearchResult searchResult = { 0 };
+
+    // initialize temporary array
+    DYNARRAY_INIT(searchResult.fileNames)
+
+    if ((ok = inputFilesCollect(args, &searchResult))) {
+        // loop over the input SVG files
+        for (size_t i = 0U; (i < searchResult.fileNames.size); ++i) {
+            ok = svgBenchmark(searchResult.fileNames.data[i].name, args);
+        }
+    }
+
+    // destroy temporary array
+    DYNARRAY_DESTROY(searchResult.fileNames)
+    return ok;
+}
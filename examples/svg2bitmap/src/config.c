@@ -65,7 +65,7 @@ void argumentsInit(CommandArguments* args) {
     // user-agent language (used during the 'systemLanguage' attribute resolving)
     args->language = defaultLanguage;
     // log buffer
-    args->logBuffer = calloc(DEFAULT_LOG_BUFFER_CAPACITY, sizeof(char));
+    args->logBuffer = memCalloc(DEFAULT_LOG_BUFFER_CAPACITY, sizeof(char));
     args->logBufferCapacity = (args->logBuffer != NULL) ? DEFAULT_LOG_BUFFER_CAPACITY : 0U;
 
     /************************************************************
@@ -112,6 +112,27 @@ void argumentsInit(CommandArguments* args) {
     args->height = DEFAULT_OUTPUT_HEIGHT;
     // additional scale to be applied to all SVG files
     args->scale = DEFAULT_OUTPUT_SCALE;
+    // render the whole SVG files, not a single element
+    args->elementId = NULL;
+    args->compact = SVGT_FALSE;
+    args->theme = NULL;
+    DYNARRAY_INIT(args->libraries)
+    args->hiddenIds = NULL;
+    args->hitTest = SVGT_FALSE;
+    args->hitTestPoint[0] = 0.0f;
+    args->hitTestPoint[1] = 0.0f;
+    args->hitTestExact = SVGT_TRUE;
+    args->deadline = 0U;
+    args->drawBudget = 0U;
+    (void)memset(&args->parseLimits, 0, sizeof(SvgScanLimits));
+    args->docStats = SVGT_FALSE;
+    args->costReport = SVGT_FALSE;
+    args->memoryStats = SVGT_FALSE;
+    args->memoryLimit = 0U;
+    args->profile = SVGT_FALSE;
+    args->profileCheck = SVGT_FALSE;
+    args->traceFileName = NULL;
+    args->benchmarkIterations = 0U;
     
     /************************************************************
                        rendering (atlas mode)
@@ -136,9 +157,10 @@ void argumentsInit(CommandArguments* args) {
 void argumentsDestroy(CommandArguments* args) {
 
     if (args->logBuffer != NULL) {
-        free(args->logBuffer);
+        memFree(args->logBuffer);
     }
     DYNARRAY_DESTROY(args->atlasInputs)
+    DYNARRAY_DESTROY(args->libraries)
 }
 
 // log the given message
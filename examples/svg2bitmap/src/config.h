@@ -73,6 +73,8 @@
 #include <string.h>
 // atlas definition
 #include "atlas.h"
+// document complexity limits
+#include "svg_scan.h"
 
 // MIN / MAX macros
 #ifndef MIN
@@ -237,6 +239,41 @@ typedef struct {
 // an array of external resources
 DYNARRAY_DECLARE(ExternalResourceDynArray, ExternalResource)
 
+// a definition (i.e. an element having an 'id' attribute) within a shared library
+typedef struct {
+    // span of the whole element (start tag, content and end tag) within the library text
+    size_t start;
+    size_t length;
+    // the definitions referenced by this one, as a range within the library 'refs' array
+    SVGTuint firstRef;
+    SVGTuint refsCount;
+} SvgLibraryDef;
+
+// arrays of definitions, and definition indices
+DYNARRAY_DECLARE(SvgLibraryDefDynArray, SvgLibraryDef)
+DYNARRAY_DECLARE(SvgLibraryRefDynArray, SVGTuint)
+
+// a shared library of definitions: an SVG file whose elements can be referenced by documents as 'name#id'
+typedef struct {
+    // full filename
+    FileName fileName;
+    // the name used by documents to reference the library (e.g. 'icons' for /data/icons.svg)
+    FileName name;
+    // library text, where ids (and the references to them) are prefixed by 'name.'
+    char* xml;
+    // definitions, in document order
+    SvgLibraryDefDynArray defs;
+    // definitions referenced by each definition
+    SvgLibraryRefDynArray refs;
+    // id (without prefix) --> definition index
+    StringHashMap ids;
+    // storage for ids, one null-terminated string after the other
+    char* idsBuffer;
+} SvgLibrary;
+
+// an array of shared libraries
+DYNARRAY_DECLARE(SvgLibraryDynArray, SvgLibrary)
+
 /************************************************************
                       Program arguments
 ************************************************************/
@@ -299,6 +336,43 @@ typedef struct {
     SVGTint height;
     // additional scale to be applied to all SVG files; it is a positive number
     SVGTfloat scale;
+    // if non NULL, only the first-level element having this 'id' attribute will be rendered
+    const char* elementId;
+    // if true, content not needed for drawing (comments, metadata, editor data, blank text) is removed before parsing
+    SVGTboolean compact;
+    // if non NULL, a list of style overrides ("key=value,key=value,...") applied to all SVG files before parsing
+    const char* theme;
+    // shared libraries of definitions; references like 'name#id' within SVG files are resolved against them before parsing
+    SvgLibraryDynArray libraries;
+    // if non NULL, a list of first-level element ids (separated by comma) that will be hidden, without re-parsing the document
+    const char* hiddenIds;
+    // if true, report the first-level elements found under the 'hitTestPoint' (expressed in output pixels)
+    SVGTboolean hitTest;
+    SVGTfloat hitTestPoint[2];
+    // if true, elements are hit only by their painted pixels, else by their bounding boxes
+    SVGTboolean hitTestExact;
+    // drawing deadline for each file, in milliseconds (0 means no deadline); when exceeded, the partially drawn surface is written
+    SVGTuint deadline;
+    // if greater than zero, the document is drawn incrementally, in steps limited by this time budget (in microseconds)
+    SVGTuint drawBudget;
+    // complexity limits for untrusted input, checked before parsing (filter pixels before drawing); files exceeding them are rejected
+    SvgScanLimits parseLimits;
+    // if true, complexity statistics (elements by type, path segments, nesting depth, ...) are reported for each file
+    SVGTboolean docStats;
+    // if true, the document is drawn element by element, reporting the elements that are most expensive to draw
+    SVGTboolean costReport;
+    // if true, memory usage (drawing surface, elements index, heap) is reported for each rendered file
+    SVGTboolean memoryStats;
+    // heap memory limit, in megabytes (0 means no limit); drawing surfaces are checked against it too
+    SVGTuint memoryLimit;
+    // if true, the time spent in each processing phase (load, parse, draw, encode, ...) is reported at the end
+    SVGTboolean profile;
+    // if true, counting zone hooks are installed on the profiler, checking at the end that zones are balanced
+    SVGTboolean profileCheck;
+    // if non NULL, a Chrome trace event file (JSON) where processing phases are written to
+    const char* traceFileName;
+    // if greater than zero, input files are not rendered: each one is parsed (and destroyed) the given number of times, reporting timings
+    SVGTuint benchmarkIterations;
 
     /************************************************************
                        rendering (atlas mode)
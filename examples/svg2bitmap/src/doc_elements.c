@@ -0,0 +1,1046 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file doc_elements.c
+    \brief Addressing and drawing of single (first-level) SVG elements, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "doc_elements.h"
+#include "point_map.h"
+#include "rendering.h"
+#include "timer.h"
+#include <math.h>
+
+// maximum number of packing attempts, each one with an halved scale
+#define ELEMENTS_PACKING_MAX_ATTEMPTS 8U
+// maximum number of elements referenced by a leaf node of the bounding volume hierarchy
+#define BVH_LEAF_MAX_ELEMENTS 4U
+
+// round the given number
+static SVGTint roundInteger(const SVGTfloat v) {
+
+    return (v < 0.0f) ? (SVGTint)(v - 0.5f) : (SVGTint)(v + 0.5f);
+}
+
+// sort elements by z-order
+static int elementsCompare(const void* a,
+                           const void* b) {
+
+    const SVGTint z0 = ((const DocElement*)a)->rect.zOrder;
+    const SVGTint z1 = ((const DocElement*)b)->rect.zOrder;
+
+    return (z0 < z1) ? -1 : ((z0 > z1) ? 1 : 0);
+}
+
+// copy the elements packed by the last (closed) packing task
+static SVGTErrorCode elementsCollect(DocElements* elems) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    const SVGTint binsCount = svgtPackingBinsCount();
+
+    for (SVGTint i = 0; (i < binsCount) && (err == SVGT_NO_ERROR); ++i) {
+
+        SVGTuint binInfo[3] = { 0U, 0U, 0U };
+
+        // binInfo[2] = number of packed elements inside the bin
+        if ((err = svgtPackingBinInfo((SVGTuint)i, binInfo)) == SVGT_NO_ERROR) {
+
+            const SVGTPackedRect* rects = svgtPackingBinRects((SVGTuint)i);
+
+            for (SVGTuint j = 0U; (rects != NULL) && (j < binInfo[2]) && (err == SVGT_NO_ERROR); ++j) {
+
+                const size_t oldSize = elems->elements.size;
+                DocElement elem;
+
+                elem.rect = rects[j];
+                // 'elemName' memory is owned by AmanithSVG, so keep a private copy of it (within the ids arena)
+                elem.id = arenaStrClone(&elems->idArena, rects[j].elemName);
+                elem.rect.elemName = elem.id;
+                elem.visible = SVGT_TRUE;
+                elem.dirty = SVGT_FALSE;
+                if ((rects[j].elemName != NULL) && (elem.id == NULL)) {
+                    err = SVGT_OUT_OF_MEMORY_ERROR;
+                }
+                else {
+                    DYNARRAY_PUSH_BACK(elems->elements, DocElement, elem)
+                    if (elems->elements.size == oldSize) {
+                        err = SVGT_OUT_OF_MEMORY_ERROR;
+                    }
+                }
+            }
+        }
+    }
+
+    return err;
+}
+
+// map the packer pixel space back to the document coordinate system, filling the bounding box of each element
+static SVGTErrorCode elementsBBoxCalc(DocElements* elems) {
+
+    // no elements, nothing to map
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    SVGTfloat docViewport[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    SVGTuint alignment[2] = { SVGT_ASPECT_RATIO_ALIGN_XMIDYMID, SVGT_ASPECT_RATIO_MEET };
+
+    if ((elems->elements.size > 0U) &&
+        ((err = svgtDocViewportGet(elems->docHandle, docViewport)) == SVGT_NO_ERROR) &&
+        ((err = svgtDocViewportAlignmentGet(elems->docHandle, alignment)) == SVGT_NO_ERROR)) {
+
+        // all elements share the same destination viewport
+        const SVGTPackedRect* r0 = &elems->elements.data[0].rect;
+        // viewBox --> destination viewport transformation (see SVG 'preserveAspectRatio' attribute)
+        SVGTfloat sx = r0->dstViewportWidth / docViewport[2];
+        SVGTfloat sy = r0->dstViewportHeight / docViewport[3];
+        SVGTfloat tx = 0.0f;
+        SVGTfloat ty = 0.0f;
+
+        if (alignment[0] != SVGT_ASPECT_RATIO_ALIGN_NONE) {
+            // 0 = min, 1 = mid, 2 = max
+            const SVGTuint alignX = (alignment[0] - 1U) % 3U;
+            const SVGTuint alignY = (alignment[0] - 1U) / 3U;
+            // uniform scaling
+            sx = (alignment[1] == SVGT_ASPECT_RATIO_MEET) ? MIN(sx, sy) : MAX(sx, sy);
+            sy = sx;
+            tx = (r0->dstViewportWidth - (docViewport[2] * sx)) * (SVGTfloat)alignX * 0.5f;
+            ty = (r0->dstViewportHeight - (docViewport[3] * sy)) * (SVGTfloat)alignY * 0.5f;
+        }
+
+        // keep track of the mapping used by the packer, and of the transformation: pixel = (doc * scale) + translation
+        elems->packViewport[0] = docViewport[0];
+        elems->packViewport[1] = docViewport[1];
+        elems->packViewport[2] = docViewport[2];
+        elems->packViewport[3] = docViewport[3];
+        elems->packAlignment[0] = alignment[0];
+        elems->packAlignment[1] = alignment[1];
+        elems->docToPixel[0] = sx;
+        elems->docToPixel[1] = sy;
+        elems->docToPixel[2] = tx - (docViewport[0] * sx);
+        elems->docToPixel[3] = ty - (docViewport[1] * sy);
+
+        for (size_t i = 0U; i < elems->elements.size; ++i) {
+
+            DocElement* elem = &elems->elements.data[i];
+            const SVGTPackedRect* r = &elem->rect;
+
+            // apply the inverse transformation
+            elem->bbox[0] = ((SVGTfloat)r->originalX - elems->docToPixel[2]) / sx;
+            elem->bbox[1] = ((SVGTfloat)r->originalY - elems->docToPixel[3]) / sy;
+            elem->bbox[2] = (SVGTfloat)r->width / sx;
+            elem->bbox[3] = (SVGTfloat)r->height / sy;
+        }
+    }
+
+    return err;
+}
+
+// build the (sub)tree of the bounding volume hierarchy rooted at the given node, covering 'count' entries of the 'bvhIndices' array
+static void bvhBuild(DocElements* elems,
+                     const SVGTuint nodeIdx,
+                     const SVGTuint first,
+                     const SVGTuint count) {
+
+    DocBVHNode* node = &elems->bvhNodes[nodeIdx];
+    SVGTfloat centroidsBox[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    // calculate node box (and the box of element centroids)
+    for (SVGTuint i = 0U; i < count; ++i) {
+
+        const SVGTfloat* bbox = elems->elements.data[elems->bvhIndices[first + i]].bbox;
+        const SVGTfloat cx = bbox[0] + (bbox[2] * 0.5f);
+        const SVGTfloat cy = bbox[1] + (bbox[3] * 0.5f);
+
+        if (i == 0U) {
+            node->box[0] = bbox[0];
+            node->box[1] = bbox[1];
+            node->box[2] = bbox[0] + bbox[2];
+            node->box[3] = bbox[1] + bbox[3];
+            centroidsBox[0] = centroidsBox[2] = cx;
+            centroidsBox[1] = centroidsBox[3] = cy;
+        }
+        else {
+            node->box[0] = MIN(node->box[0], bbox[0]);
+            node->box[1] = MIN(node->box[1], bbox[1]);
+            node->box[2] = MAX(node->box[2], bbox[0] + bbox[2]);
+            node->box[3] = MAX(node->box[3], bbox[1] + bbox[3]);
+            centroidsBox[0] = MIN(centroidsBox[0], cx);
+            centroidsBox[1] = MIN(centroidsBox[1], cy);
+            centroidsBox[2] = MAX(centroidsBox[2], cx);
+            centroidsBox[3] = MAX(centroidsBox[3], cy);
+        }
+    }
+
+    if (count <= BVH_LEAF_MAX_ELEMENTS) {
+        // leaf node
+        node->first = first;
+        node->count = count;
+    }
+    else {
+        // split along the longest axis of the centroids box, at its midpoint
+        const SVGTuint axis = ((centroidsBox[2] - centroidsBox[0]) >= (centroidsBox[3] - centroidsBox[1])) ? 0U : 1U;
+        const SVGTfloat mid = (centroidsBox[axis] + centroidsBox[axis + 2U]) * 0.5f;
+        const SVGTuint leftIdx = elems->bvhNodesCount;
+        SVGTuint split = 0U;
+
+        // partition entries
+        for (SVGTuint i = 0U; i < count; ++i) {
+
+            const SVGTuint elemIdx = elems->bvhIndices[first + i];
+            const SVGTfloat* bbox = elems->elements.data[elemIdx].bbox;
+
+            if ((bbox[axis] + (bbox[axis + 2U] * 0.5f)) < mid) {
+                elems->bvhIndices[first + i] = elems->bvhIndices[first + split];
+                elems->bvhIndices[first + split] = elemIdx;
+                split++;
+            }
+        }
+        // all centroids on the same side (e.g. coincident), just halve the entries
+        if ((split == 0U) || (split == count)) {
+            split = count / 2U;
+        }
+
+        // children are stored consecutively
+        elems->bvhNodesCount += 2U;
+        node->first = leftIdx;
+        node->count = 0U;
+        bvhBuild(elems, leftIdx, first, split);
+        bvhBuild(elems, leftIdx + 1U, first + split, count - split);
+    }
+}
+
+// collect all the elements whose bounding box contains the given point (expressed in document coordinates)
+static SVGTErrorCode bvhQuery(DocElements* elems,
+                              const SVGTuint nodeIdx,
+                              const SVGTfloat x,
+                              const SVGTfloat y) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    const DocBVHNode* node = &elems->bvhNodes[nodeIdx];
+
+    if ((x >= node->box[0]) && (y >= node->box[1]) && (x <= node->box[2]) && (y <= node->box[3])) {
+
+        if (node->count > 0U) {
+
+            for (SVGTuint i = 0U; (i < node->count) && (err == SVGT_NO_ERROR); ++i) {
+
+                const SVGTuint elemIdx = elems->bvhIndices[node->first + i];
+                const SVGTfloat* bbox = elems->elements.data[elemIdx].bbox;
+
+                // hidden elements cannot be hit
+                if (elems->elements.data[elemIdx].visible &&
+                    (x >= bbox[0]) && (y >= bbox[1]) && (x <= bbox[0] + bbox[2]) && (y <= bbox[1] + bbox[3])) {
+
+                    const size_t oldSize = elems->hitCandidates.size;
+
+                    DYNARRAY_PUSH_BACK(elems->hitCandidates, SVGTuint, elemIdx)
+                    if (elems->hitCandidates.size == oldSize) {
+                        err = SVGT_OUT_OF_MEMORY_ERROR;
+                    }
+                }
+            }
+        }
+        else
+        if ((err = bvhQuery(elems, node->first, x, y)) == SVGT_NO_ERROR) {
+            err = bvhQuery(elems, node->first + 1U, x, y);
+        }
+    }
+
+    return err;
+}
+
+// sort element indices from the topmost to the bottommost
+static int candidatesCompare(const void* a,
+                             const void* b) {
+
+    const SVGTuint i0 = *(const SVGTuint*)a;
+    const SVGTuint i1 = *(const SVGTuint*)b;
+
+    return (i0 > i1) ? -1 : ((i0 < i1) ? 1 : 0);
+}
+
+// build the bounding volume hierarchy of all elements
+static SVGTErrorCode elementsBVHBuild(DocElements* elems) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    const SVGTuint n = (SVGTuint)elems->elements.size;
+
+    if ((elems->bvhNodes == NULL) && (n > 0U)) {
+
+        // a binary tree with (at most) n leaves has (at most) 2n - 1 nodes
+        elems->bvhNodes = memMalloc(2U * n * sizeof(DocBVHNode));
+        elems->bvhIndices = memMalloc(n * sizeof(SVGTuint));
+
+        if ((elems->bvhNodes != NULL) && (elems->bvhIndices != NULL)) {
+
+            for (SVGTuint i = 0U; i < n; ++i) {
+                elems->bvhIndices[i] = i;
+            }
+            elems->bvhNodesCount = 1U;
+            bvhBuild(elems, 0U, 0U, n);
+        }
+        else {
+            memFree(elems->bvhNodes);
+            elems->bvhNodes = NULL;
+            memFree(elems->bvhIndices);
+            elems->bvhIndices = NULL;
+            err = SVGT_OUT_OF_MEMORY_ERROR;
+        }
+    }
+
+    return err;
+}
+
+// tell if the given element paints the specified point, expressed in document coordinates
+static SVGTErrorCode elementPixelProbe(DocElements* elems,
+                                       const SVGTuint elemIdx,
+                                       const SVGTfloat x,
+                                       const SVGTfloat y,
+                                       const SVGTfloat scale,
+                                       SVGTboolean* hit) {
+
+    SVGTErrorCode err;
+    const SVGTPackedRect* r = &elems->elements.data[elemIdx].rect;
+    SVGTPackedRect q = *r;
+    // point position, in pixels, at the given scale
+    const SVGTfloat px = ((x * elems->docToPixel[0]) + elems->docToPixel[2]) * scale;
+    const SVGTfloat py = ((y * elems->docToPixel[1]) + elems->docToPixel[3]) * scale;
+
+    // scale the element box, and the whole document viewport accordingly
+    q.originalX = roundInteger((SVGTfloat)r->originalX * scale);
+    q.originalY = roundInteger((SVGTfloat)r->originalY * scale);
+    q.width = roundInteger((SVGTfloat)r->width * scale);
+    q.height = roundInteger((SVGTfloat)r->height * scale);
+    q.dstViewportWidth = r->dstViewportWidth * scale;
+    q.dstViewportHeight = r->dstViewportHeight * scale;
+    // translate the element so that the probed pixel falls at (0, 0)
+    q.x = q.originalX - (SVGTint)floorf(px);
+    q.y = q.originalY - (SVGTint)floorf(py);
+
+    *hit = SVGT_FALSE;
+    if (((err = svgtSurfaceClear(elems->hitSurface, 0.0f, 0.0f, 0.0f, 0.0f)) == SVGT_NO_ERROR) &&
+        ((err = svgtPackingRectsDraw(&q, 1U, elems->hitSurface, SVGT_RENDERING_QUALITY_BETTER)) == SVGT_NO_ERROR)) {
+
+        const SVGTubyte* pixel = (const SVGTubyte*)svgtSurfacePixels(elems->hitSurface);
+
+        // pixels are premultiplied, so a non-zero alpha is enough
+        *hit = ((pixel != NULL) && (pixel[3] > 0U)) ? SVGT_TRUE : SVGT_FALSE;
+    }
+
+    return err;
+}
+
+// placement of packed elements on a drawing surface
+typedef struct {
+    // packer pixel space --> surface space transformation (used for element boxes): scale x, scale y, translation x, translation y
+    SVGTfloat xform[4];
+    // destination viewport (width, height) assigned to packed rectangles
+    SVGTfloat dstViewport[2];
+    // translation applied by packed rectangles (i.e. x - originalX, y - originalY), in whole pixels
+    SVGTint offset[2];
+} ElementsPlacement;
+
+// get the placement of packed elements on the given surface, according to the current document and surface viewports
+static SVGTErrorCode elementsPlacementGet(const DocElements* elems,
+                                          SVGTHandle surface,
+                                          ElementsPlacement* placement) {
+
+    SVGTErrorCode err;
+    SVGTfloat m[6];
+    SVGTfloat docViewport[4];
+    SVGTfloat surfaceViewport[4];
+    SVGTuint alignment[2];
+
+    if (((err = pointMapMatrix(elems->docHandle, surface, SVGT_FALSE, m)) == SVGT_NO_ERROR) &&
+        ((err = svgtDocViewportGet(elems->docHandle, docViewport)) == SVGT_NO_ERROR) &&
+        ((err = svgtDocViewportAlignmentGet(elems->docHandle, alignment)) == SVGT_NO_ERROR) &&
+        ((err = svgtSurfaceViewportGet(surface, surfaceViewport)) == SVGT_NO_ERROR)) {
+
+        // surface = (m * doc) + t = (k * pixel) - (k * docToPixel.t) + t
+        const SVGTfloat tx = m[4] - ((m[0] / elems->docToPixel[0]) * elems->docToPixel[2]);
+        const SVGTfloat ty = m[5] - ((m[3] / elems->docToPixel[1]) * elems->docToPixel[3]);
+
+        placement->xform[0] = m[0] / elems->docToPixel[0];
+        placement->xform[1] = m[3] / elems->docToPixel[1];
+
+        if ((docViewport[0] == elems->packViewport[0]) && (docViewport[1] == elems->packViewport[1]) &&
+            (docViewport[2] == elems->packViewport[2]) && (docViewport[3] == elems->packViewport[3]) &&
+            (alignment[0] == elems->packAlignment[0]) && (alignment[1] == elems->packAlignment[1]) &&
+            (surfaceViewport[0] == floorf(surfaceViewport[0])) && (surfaceViewport[1] == floorf(surfaceViewport[1]))) {
+            // the document is mapped as the packer maps it, so packed rectangles can take the surface viewport as their
+            // destination viewport: AmanithSVG then places each element exactly where svgtDocDraw would, fractional
+            // offsets (e.g. the ones induced by the alignment) included
+            placement->xform[2] = tx;
+            placement->xform[3] = ty;
+            placement->dstViewport[0] = surfaceViewport[2];
+            placement->dstViewport[1] = surfaceViewport[3];
+            placement->offset[0] = (SVGTint)surfaceViewport[0];
+            placement->offset[1] = (SVGTint)surfaceViewport[1];
+        }
+        else {
+            // the document viewport has been changed after the packing: scale the packer destination viewport, and round
+            // the translation to whole pixels (packed rectangles can be placed at integer positions only)
+            placement->offset[0] = roundInteger(tx);
+            placement->offset[1] = roundInteger(ty);
+            placement->xform[2] = (SVGTfloat)placement->offset[0];
+            placement->xform[3] = (SVGTfloat)placement->offset[1];
+            // all packed rectangles share the same destination viewport
+            placement->dstViewport[0] = (elems->elements.size > 0U) ? (elems->elements.data[0].rect.dstViewportWidth * placement->xform[0]) : 0.0f;
+            placement->dstViewport[1] = (elems->elements.size > 0U) ? (elems->elements.data[0].rect.dstViewportHeight * placement->xform[1]) : 0.0f;
+        }
+    }
+
+    return err;
+}
+
+// get the packed rectangle that draws the specified element on the surface, according to the given placement, and the
+// element box on the surface (enlarged to whole pixels): box[0] = min x, box[1] = min y, box[2] = max x, box[3] = max y (exclusive)
+static void elementSurfaceRect(const DocElements* elems,
+                               const SVGTuint elemIdx,
+                               const ElementsPlacement* placement,
+                               SVGTPackedRect* q,
+                               SVGTint* box) {
+
+    const SVGTPackedRect* r = &elems->elements.data[elemIdx].rect;
+    const SVGTfloat* xform = placement->xform;
+
+    // packed rectangles are drawn translated by (x - originalX, y - originalY); the other fields are left as the packer
+    // calculated them, because AmanithSVG takes them into account when rasterizing
+    *q = *r;
+    q->x = r->originalX + placement->offset[0];
+    q->y = r->originalY + placement->offset[1];
+    q->dstViewportWidth = placement->dstViewport[0];
+    q->dstViewportHeight = placement->dstViewport[1];
+    box[0] = (SVGTint)floorf(((SVGTfloat)r->originalX * xform[0]) + xform[2]);
+    box[1] = (SVGTint)floorf(((SVGTfloat)r->originalY * xform[1]) + xform[3]);
+    box[2] = (SVGTint)ceilf(((SVGTfloat)(r->originalX + r->width) * xform[0]) + xform[2]);
+    box[3] = (SVGTint)ceilf(((SVGTfloat)(r->originalY + r->height) * xform[1]) + xform[3]);
+}
+
+// build the index of first-level elements of the given document
+SVGTErrorCode docElementsBuild(DocElements* elems,
+                               const SVGTHandle docHandle) {
+
+    SVGTErrorCode err;
+    SVGTuint attempts = 0U;
+    SVGTboolean packed = SVGT_FALSE;
+    SVGTfloat scale = 1.0f;
+    const SVGTuint maxDimension = svgtSurfaceMaxDimension();
+
+    elems->docHandle = docHandle;
+    DYNARRAY_INIT(elems->elements)
+    arenaInit(&elems->idArena, ARENA_DEFAULT_BLOCK_SIZE);
+    elems->docToPixel[0] = 1.0f;
+    elems->docToPixel[1] = 1.0f;
+    elems->docToPixel[2] = 0.0f;
+    elems->docToPixel[3] = 0.0f;
+    elems->packViewport[0] = elems->packViewport[1] = elems->packViewport[2] = elems->packViewport[3] = 0.0f;
+    elems->packAlignment[0] = SVGT_ASPECT_RATIO_ALIGN_XMIDYMID;
+    elems->packAlignment[1] = SVGT_ASPECT_RATIO_MEET;
+    elems->bvhNodes = NULL;
+    elems->bvhNodesCount = 0U;
+    elems->bvhIndices = NULL;
+    DYNARRAY_INIT(elems->hitCandidates)
+    elems->hitSurface = SVGT_INVALID_HANDLE;
+
+    if ((err = strHashMapInit(&elems->idHashmap, 64U)) == SVGT_NO_ERROR) {
+
+        // pack each first-level element separately; elements that exceed the maximum dimension are discarded by
+        // the packer, in this case try again with a smaller scale (the drawing will rescale elements anyway)
+        while ((!packed) && (err == SVGT_NO_ERROR) && (attempts < ELEMENTS_PACKING_MAX_ATTEMPTS)) {
+
+            if ((err = svgtPackingBegin(maxDimension, 0U, SVGT_FALSE, scale)) == SVGT_NO_ERROR) {
+
+                SVGTuint info[2] = { 0U, 0U };
+
+                if ((err = svgtPackingAdd(docHandle, SVGT_TRUE, 1.0f, info)) == SVGT_NO_ERROR) {
+                    // info[0] = number of collected elements
+                    // info[1] = the actual number of elements that could be packed
+                    packed = (info[0] == info[1]) ? SVGT_TRUE : SVGT_FALSE;
+                }
+                // close the packing task, performing the real packing only if all elements fit
+                (void)svgtPackingEnd(packed);
+            }
+            scale *= 0.5f;
+            attempts++;
+        }
+
+        if ((err == SVGT_NO_ERROR) && packed) {
+
+            if (((err = elementsCollect(elems)) == SVGT_NO_ERROR) && ((err = elementsBBoxCalc(elems)) == SVGT_NO_ERROR)) {
+
+                // sort elements from the bottommost to the topmost
+                qsort(elems->elements.data, elems->elements.size, sizeof(DocElement), elementsCompare);
+
+                // map 'id' attributes; in case of duplicated ids, the first one in document order wins
+                for (size_t i = 0U; (i < elems->elements.size) && (err == SVGT_NO_ERROR); ++i) {
+
+                    const char* id = elems->elements.data[i].id;
+                    HashedElementData* value = NULL;
+
+                    if ((id != NULL) && (*id != '\0') && (!strHashMapGet(&elems->idHashmap, id, &value))) {
+                        HashedElementData v;
+                        v.u = (SVGTuint)i;
+                        err = strHashMapPut(&elems->idHashmap, id, v);
+                    }
+                }
+            }
+        }
+        else
+        if (err == SVGT_NO_ERROR) {
+            // some elements are too big to be packed, even at the smallest scale
+            err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+        }
+    }
+
+    return err;
+}
+
+// release the given elements index
+void docElementsDestroy(DocElements* elems) {
+
+    // all ids are released at once
+    arenaDestroy(&elems->idArena);
+    DYNARRAY_DESTROY(elems->elements)
+    DYNARRAY_INIT(elems->elements)
+    strHashMapDestroy(&elems->idHashmap);
+    memFree(elems->bvhNodes);
+    elems->bvhNodes = NULL;
+    elems->bvhNodesCount = 0U;
+    memFree(elems->bvhIndices);
+    elems->bvhIndices = NULL;
+    DYNARRAY_DESTROY(elems->hitCandidates)
+    DYNARRAY_INIT(elems->hitCandidates)
+    if (elems->hitSurface != SVGT_INVALID_HANDLE) {
+        surfaceDestroy(elems->hitSurface);
+        elems->hitSurface = SVGT_INVALID_HANDLE;
+    }
+    elems->docHandle = SVGT_INVALID_HANDLE;
+}
+
+// get the amount of memory used by the given elements index, in bytes
+size_t docElementsMemoryUsage(const DocElements* elems) {
+
+    size_t result = (elems->elements.capacity * sizeof(DocElement)) +
+                    ((size_t)elems->idHashmap.tableSize * sizeof(StringHashMapElement)) +
+                    arenaMemoryUsage(&elems->idArena) +
+                    (elems->hitCandidates.capacity * sizeof(SVGTuint));
+
+    if (elems->bvhNodes != NULL) {
+        // see elementsBVHBuild
+        result += elems->elements.size * ((2U * sizeof(DocBVHNode)) + sizeof(SVGTuint));
+    }
+    if (elems->hitSurface != SVGT_INVALID_HANDLE) {
+        result += surfaceMemoryUsage(elems->hitSurface);
+    }
+
+    return result;
+}
+
+// find the element having the given 'id' attribute, returning its index (a negative number if not found)
+SVGTint docElementFind(DocElements* elems,
+                       const char* id) {
+
+    HashedElementData* value = NULL;
+
+    return ((id != NULL) && (elems->idHashmap.tableSize > 0U) && strHashMapGet(&elems->idHashmap, id, &value)) ? (SVGTint)value->u : -1;
+}
+
+// get the bounding box (stroke included) of the specified element
+SVGTErrorCode docElementBBox(const DocElements* elems,
+                             const SVGTuint elemIdx,
+                             const DocElementSpace space,
+                             SVGTHandle surface,
+                             SVGTfloat* bbox) {
+
+    SVGTErrorCode err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+
+    if ((elemIdx < elems->elements.size) && (bbox != NULL)) {
+
+        const SVGTfloat* docBBox = elems->elements.data[elemIdx].bbox;
+
+        if (space == DOC_ELEMENT_SPACE_DOCUMENT) {
+            (void)memcpy(bbox, docBBox, 4U * sizeof(SVGTfloat));
+            err = SVGT_NO_ERROR;
+        }
+        else
+        if (space == DOC_ELEMENT_SPACE_SURFACE) {
+
+            // the four box corners
+            SVGTfloat corners[8] = {
+                docBBox[0], docBBox[1],
+                docBBox[0] + docBBox[2], docBBox[1],
+                docBBox[0], docBBox[1] + docBBox[3],
+                docBBox[0] + docBBox[2], docBBox[1] + docBBox[3]
+            };
+
+            // map the four box corners (the mapping may include a flip, so take the enclosing box)
+            if ((err = pointMapBatch(elems->docHandle, surface, corners, corners, 4U, SVGT_FALSE)) == SVGT_NO_ERROR) {
+
+                const SVGTfloat minX = MIN(MIN(corners[0], corners[2]), MIN(corners[4], corners[6]));
+                const SVGTfloat minY = MIN(MIN(corners[1], corners[3]), MIN(corners[5], corners[7]));
+                const SVGTfloat maxX = MAX(MAX(corners[0], corners[2]), MAX(corners[4], corners[6]));
+                const SVGTfloat maxY = MAX(MAX(corners[1], corners[3]), MAX(corners[5], corners[7]));
+
+                bbox[0] = minX;
+                bbox[1] = minY;
+                bbox[2] = maxX - minX;
+                bbox[3] = maxY - minY;
+            }
+        }
+    }
+
+    return err;
+}
+
+// draw the specified element over the given surface; the element is scaled uniformly and centered in order to fit the whole surface
+SVGTErrorCode docElementDraw(const DocElements* elems,
+                             const SVGTuint elemIdx,
+                             SVGTHandle surface,
+                             const SVGTRenderingQuality renderingQuality) {
+
+    SVGTErrorCode err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+
+    if (elemIdx < elems->elements.size) {
+
+        const SVGTPackedRect* r = &elems->elements.data[elemIdx].rect;
+        const SVGTuint srfWidth = svgtSurfaceWidth(surface);
+        const SVGTuint srfHeight = svgtSurfaceHeight(surface);
+
+        if ((srfWidth == 0U) || (srfHeight == 0U)) {
+            err = SVGT_BAD_HANDLE_ERROR;
+        }
+        else
+        if ((r->width <= 0) || (r->height <= 0)) {
+            // nothing to draw
+            err = SVGT_NO_ERROR;
+        }
+        else {
+            SVGTPackedRect q = *r;
+            // the scale that fits the element box within the surface
+            const SVGTfloat widthScale = (SVGTfloat)srfWidth / (SVGTfloat)r->width;
+            const SVGTfloat heightScale = (SVGTfloat)srfHeight / (SVGTfloat)r->height;
+            const SVGTfloat scale = (widthScale < heightScale) ? widthScale : heightScale;
+
+            // scale the element box, and the whole document viewport accordingly
+            q.originalX = roundInteger((SVGTfloat)r->originalX * scale);
+            q.originalY = roundInteger((SVGTfloat)r->originalY * scale);
+            q.width = roundInteger((SVGTfloat)r->width * scale);
+            q.height = roundInteger((SVGTfloat)r->height * scale);
+            q.dstViewportWidth = r->dstViewportWidth * scale;
+            q.dstViewportHeight = r->dstViewportHeight * scale;
+            // center the element within the surface
+            q.x = ((SVGTint)srfWidth - q.width) / 2;
+            q.y = ((SVGTint)srfHeight - q.height) / 2;
+            // draw the element alone
+            err = svgtPackingRectsDraw(&q, 1U, surface, renderingQuality);
+        }
+    }
+
+    return err;
+}
+
+// show or hide the specified element
+SVGTErrorCode docElementVisibilitySet(DocElements* elems,
+                                      const SVGTuint elemIdx,
+                                      const SVGTboolean visible) {
+
+    SVGTErrorCode err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+
+    if (elemIdx < elems->elements.size) {
+
+        DocElement* elem = &elems->elements.data[elemIdx];
+
+        if (elem->visible != visible) {
+            elem->visible = visible;
+            elem->dirty = SVGT_TRUE;
+        }
+        err = SVGT_NO_ERROR;
+    }
+
+    return err;
+}
+
+// get the surface region covered by dirty elements
+SVGTErrorCode docElementsDirtyRect(const DocElements* elems,
+                                   SVGTHandle surface,
+                                   SVGTint* rect) {
+
+    SVGTErrorCode err;
+    ElementsPlacement placement;
+
+    rect[0] = rect[1] = rect[2] = rect[3] = 0;
+
+    if ((err = elementsPlacementGet(elems, surface, &placement)) == SVGT_NO_ERROR) {
+
+        const SVGTint srfWidth = (SVGTint)svgtSurfaceWidth(surface);
+        const SVGTint srfHeight = (SVGTint)svgtSurfaceHeight(surface);
+        SVGTint minX = srfWidth, minY = srfHeight, maxX = 0, maxY = 0;
+
+        // union of dirty elements boxes (packed rectangles are conservative, so no rounding is needed)
+        for (size_t i = 0U; i < elems->elements.size; ++i) {
+
+            if (elems->elements.data[i].dirty) {
+
+                SVGTPackedRect q;
+                SVGTint box[4];
+
+                elementSurfaceRect(elems, (SVGTuint)i, &placement, &q, box);
+                minX = MIN(minX, box[0]);
+                minY = MIN(minY, box[1]);
+                maxX = MAX(maxX, box[2]);
+                maxY = MAX(maxY, box[3]);
+            }
+        }
+
+        // clip to the surface
+        minX = MAX(minX, 0);
+        minY = MAX(minY, 0);
+        maxX = MIN(maxX, srfWidth);
+        maxY = MIN(maxY, srfHeight);
+        if ((maxX > minX) && (maxY > minY)) {
+            rect[0] = minX;
+            rect[1] = minY;
+            rect[2] = maxX - minX;
+            rect[3] = maxY - minY;
+        }
+    }
+
+    return err;
+}
+
+// draw visible elements, as the whole document would be drawn on 'surface', limiting the drawing to the given region
+SVGTErrorCode docElementsRegionDraw(DocElements* elems,
+                                    SVGTHandle surface,
+                                    const SVGTint* region,
+                                    SVGTHandle dstSurface,
+                                    const SVGTRenderingQuality renderingQuality) {
+
+    SVGTErrorCode err;
+    ElementsPlacement placement;
+
+    if ((err = elementsPlacementGet(elems, surface, &placement)) == SVGT_NO_ERROR) {
+
+        const SVGTint rx = (region != NULL) ? region[0] : 0;
+        const SVGTint ry = (region != NULL) ? region[1] : 0;
+        const SVGTint sw = (SVGTint)svgtSurfaceWidth(surface);
+        const SVGTint sh = (SVGTint)svgtSurfaceHeight(surface);
+        const SVGTint rw = (region != NULL) ? region[2] : sw;
+        const SVGTint rh = (region != NULL) ? region[3] : sh;
+
+        // draw from the bottommost to the topmost, skipping hidden elements and the ones outside the region
+        for (size_t i = 0U; (i < elems->elements.size) && (err == SVGT_NO_ERROR); ++i) {
+
+            DocElement* elem = &elems->elements.data[i];
+            SVGTPackedRect q;
+            SVGTint box[4];
+            SVGTint x0, y0, x1, y1;
+
+            elementSurfaceRect(elems, (SVGTuint)i, &placement, &q, box);
+            // the part of the element box that falls within the surface
+            x0 = MAX(box[0], 0);
+            y0 = MAX(box[1], 0);
+            x1 = MIN(box[2], sw);
+            y1 = MIN(box[3], sh);
+
+            if ((x0 >= x1) || (y0 >= y1)) {
+                // nothing to draw on this surface, so no pending changes either
+                elem->dirty = SVGT_FALSE;
+            }
+            else
+            if ((x0 < rx + rw) && (y0 < ry + rh) && (x1 > rx) && (y1 > ry)) {
+                if (elem->visible) {
+                    // place the region at the top/left corner of the destination surface
+                    q.x -= rx;
+                    q.y -= ry;
+                    err = svgtPackingRectsDraw(&q, 1U, dstSurface, renderingQuality);
+                }
+                // pending changes are on the surface now, unless the element extends beyond the region
+                if ((x0 >= rx) && (y0 >= ry) && (x1 <= rx + rw) && (y1 <= ry + rh)) {
+                    elem->dirty = SVGT_FALSE;
+                }
+            }
+        }
+    }
+
+    return err;
+}
+
+// tell if the given drawing limits have been reached
+static SVGTboolean drawLimitsReached(const DocDrawLimits* limits) {
+
+    return ((limits->deadlineNs > 0U) && (timerNowNs() >= limits->deadlineNs)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// draw visible elements starting from the 'first' one, checking the given limits before each element; if 'progress' is
+// true, at least one element is drawn regardless of the limits; the index of the next element to draw is returned through 'next'
+static SVGTErrorCode elementsDrawFrom(DocElements* elems,
+                                     SVGTHandle surface,
+                                     const SVGTRenderingQuality renderingQuality,
+                                     const DocDrawLimits* limits,
+                                     const size_t first,
+                                     const SVGTboolean progress,
+                                     size_t* next) {
+
+    SVGTErrorCode err;
+    ElementsPlacement placement;
+    size_t i = first;
+
+    if ((err = elementsPlacementGet(elems, surface, &placement)) == SVGT_NO_ERROR) {
+
+        const SVGTint sw = (SVGTint)svgtSurfaceWidth(surface);
+        const SVGTint sh = (SVGTint)svgtSurfaceHeight(surface);
+        SVGTboolean mustDraw = progress;
+
+        // draw from the bottommost to the topmost, skipping hidden elements and the ones outside the surface
+        while ((i < elems->elements.size) && (err == SVGT_NO_ERROR)) {
+
+            DocElement* elem = &elems->elements.data[i];
+
+            if (elem->visible) {
+
+                SVGTPackedRect q;
+                SVGTint box[4];
+
+                elementSurfaceRect(elems, (SVGTuint)i, &placement, &q, box);
+                if ((box[2] > box[0]) && (box[3] > box[1]) && (box[0] < sw) && (box[1] < sh) && (box[2] > 0) && (box[3] > 0)) {
+                    if ((!mustDraw) && drawLimitsReached(limits)) {
+                        err = DOC_DRAW_CANCELLED_ERROR;
+                    }
+                    else {
+                        err = svgtPackingRectsDraw(&q, 1U, surface, renderingQuality);
+                        mustDraw = SVGT_FALSE;
+                    }
+                }
+            }
+            if (err == SVGT_NO_ERROR) {
+                // elements not drawn remain dirty
+                elem->dirty = SVGT_FALSE;
+                i++;
+            }
+        }
+    }
+
+    *next = i;
+    return err;
+}
+
+// draw visible elements on 'surface', checking the given limits before each element
+SVGTErrorCode docElementsDrawLimited(DocElements* elems,
+                                     SVGTHandle surface,
+                                     const SVGTRenderingQuality renderingQuality,
+                                     const DocDrawLimits* limits) {
+
+    size_t next;
+
+    return elementsDrawFrom(elems, surface, renderingQuality, limits, 0U, SVGT_FALSE, &next);
+}
+
+// initialize the state of an incremental drawing
+void docDrawStateInit(DocDrawState* state) {
+
+    state->next = 0U;
+    state->done = SVGT_FALSE;
+}
+
+// perform a step of an incremental drawing
+SVGTErrorCode docElementsDrawStep(DocElements* elems,
+                                  SVGTHandle surface,
+                                  const SVGTRenderingQuality renderingQuality,
+                                  const SVGTuint budgetMicros,
+                                  DocDrawState* state) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    if (!state->done) {
+
+        const DocDrawLimits limits = { timerNowNs() + ((uint64_t)budgetMicros * 1000U) };
+
+        // at least one element is drawn, so that any budget leads to completion
+        err = elementsDrawFrom(elems, surface, renderingQuality, &limits, state->next, SVGT_TRUE, &state->next);
+        if (err == DOC_DRAW_CANCELLED_ERROR) {
+            // budget exhausted, it will be resumed by the next step
+            err = SVGT_NO_ERROR;
+        }
+        else
+        if (err == SVGT_NO_ERROR) {
+            state->done = SVGT_TRUE;
+        }
+    }
+
+    return err;
+}
+
+// sort costs from the most expensive to the cheapest
+static int costsCompare(const void* a,
+                        const void* b) {
+
+    const DocElementCost* c0 = (const DocElementCost*)a;
+    const DocElementCost* c1 = (const DocElementCost*)b;
+
+    return (c0->ns < c1->ns) ? 1 : ((c0->ns > c1->ns) ? -1 : 0);
+}
+
+// draw visible elements on 'surface', measuring the cost of each one
+SVGTErrorCode docElementsCostReport(DocElements* elems,
+                                    SVGTHandle surface,
+                                    const SVGTRenderingQuality renderingQuality,
+                                    DocElementCost* costs,
+                                    SVGTuint* costsCount) {
+
+    SVGTErrorCode err;
+    ElementsPlacement placement;
+
+    *costsCount = 0U;
+
+    if ((err = elementsPlacementGet(elems, surface, &placement)) == SVGT_NO_ERROR) {
+
+        const SVGTint sw = (SVGTint)svgtSurfaceWidth(surface);
+        const SVGTint sh = (SVGTint)svgtSurfaceHeight(surface);
+
+        // draw from the bottommost to the topmost, skipping hidden elements
+        for (size_t i = 0U; (i < elems->elements.size) && (err == SVGT_NO_ERROR); ++i) {
+
+            DocElement* elem = &elems->elements.data[i];
+
+            if (elem->visible) {
+
+                SVGTPackedRect q;
+                SVGTint box[4];
+                DocElementCost* cost = &costs[*costsCount];
+
+                elementSurfaceRect(elems, (SVGTuint)i, &placement, &q, box);
+                cost->elemIdx = (SVGTuint)i;
+                cost->id = elem->id;
+                cost->ns = 0U;
+                cost->bbox[0] = cost->bbox[1] = cost->bbox[2] = cost->bbox[3] = 0;
+                cost->bboxPixels = 0U;
+                if ((box[2] > box[0]) && (box[3] > box[1]) && (box[0] < sw) && (box[1] < sh) && (box[2] > 0) && (box[3] > 0)) {
+
+                    const uint64_t t = timerNowNs();
+
+                    err = svgtPackingRectsDraw(&q, 1U, surface, renderingQuality);
+                    cost->ns = timerNowNs() - t;
+                    // bounding box, clipped against the surface
+                    cost->bbox[0] = MAX(box[0], 0);
+                    cost->bbox[1] = MAX(box[1], 0);
+                    cost->bbox[2] = MIN(box[2], sw);
+                    cost->bbox[3] = MIN(box[3], sh);
+                    cost->bboxPixels = (SVGTuint)((cost->bbox[2] - cost->bbox[0]) * (cost->bbox[3] - cost->bbox[1]));
+                }
+                (*costsCount)++;
+            }
+            elem->dirty = SVGT_FALSE;
+        }
+
+        if (err == SVGT_NO_ERROR) {
+            qsort(costs, *costsCount, sizeof(DocElementCost), costsCompare);
+        }
+    }
+
+    return err;
+}
+
+// find the elements under the given point, expressed in surface coordinates; hit elements are returned from the topmost to the bottommost
+SVGTErrorCode docHitTest(DocElements* elems,
+                         SVGTHandle surface,
+                         const SVGTfloat x,
+                         const SVGTfloat y,
+                         const DocHitTestMode mode,
+                         DocHitResult* results,
+                         const SVGTuint maxResults,
+                         SVGTuint* resultsCount) {
+
+    SVGTErrorCode err;
+    SVGTfloat m[6];
+
+    *resultsCount = 0U;
+    elems->hitCandidates.size = 0U;
+
+    if (((err = elementsBVHBuild(elems)) == SVGT_NO_ERROR) &&
+        ((err = pointMapMatrix(elems->docHandle, surface, SVGT_FALSE, m)) == SVGT_NO_ERROR) &&
+        (elems->bvhNodes != NULL)) {
+
+        // surface pixels per document unit
+        const SVGTfloat pixelScale = sqrtf((m[0] * m[0]) + (m[1] * m[1]));
+        SVGTfloat docPoint[2] = { x, y };
+
+        if (!pointMapMatrixInvert(m, m)) {
+            // degenerate viewport
+            err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+        }
+        else {
+            // surface --> document coordinates
+            pointMapTransform(m, docPoint, docPoint, 1U);
+            // broad phase: bounding boxes
+            err = bvhQuery(elems, 0U, docPoint[0], docPoint[1]);
+        }
+
+        if (err == SVGT_NO_ERROR) {
+
+            // higher indices are drawn later (i.e. they are on top)
+            qsort(elems->hitCandidates.data, elems->hitCandidates.size, sizeof(SVGTuint), candidatesCompare);
+
+            if ((mode == DOC_HIT_TEST_EXACT) && (elems->hitSurface == SVGT_INVALID_HANDLE)) {
+                // accounted within memory statistics (and checked against the memory limit) as the other drawing surfaces
+                err = surfaceCreate(1U, 1U, &elems->hitSurface);
+            }
+
+            // narrow phase: painted pixels (exact mode only)
+            for (size_t i = 0U; (i < elems->hitCandidates.size) && (*resultsCount < maxResults) && (err == SVGT_NO_ERROR); ++i) {
+
+                const SVGTuint elemIdx = elems->hitCandidates.data[i];
+                SVGTboolean hit = SVGT_TRUE;
+
+                if (mode == DOC_HIT_TEST_EXACT) {
+                    // probe at the surface resolution
+                    err = elementPixelProbe(elems, elemIdx, docPoint[0], docPoint[1], pixelScale / elems->docToPixel[0], &hit);
+                }
+
+                if ((err == SVGT_NO_ERROR) && hit) {
+                    results[*resultsCount].elemIdx = elemIdx;
+                    results[*resultsCount].id = elems->elements.data[elemIdx].id;
+                    (*resultsCount)++;
+                }
+            }
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,261 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef DOC_ELEMENTS_H
+#define DOC_ELEMENTS_H
+
+/*!
+    \file doc_elements.h
+    \brief Addressing and drawing of single (first-level) SVG elements, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "arena.h"
+#include "config.h"
+#include <stdint.h>
+
+// a first-level element of an SVG document
+typedef struct {
+    // 'id' attribute (private copy, owned by the ids arena), NULL if not present
+    char* id;
+    // element rectangle, as calculated by AmanithSVG packer; 'x' and 'y' fields are meaningless here
+    SVGTPackedRect rect;
+    // bounding box (stroke included) in document coordinates: x, y, width, height
+    SVGTfloat bbox[4];
+    // visibility state, it can be changed without re-parsing the document
+    SVGTboolean visible;
+    // true if the element state has changed since the last docElementsRegionDraw
+    SVGTboolean dirty;
+} DocElement;
+
+// coordinate systems in which element bounding boxes can be expressed
+typedef enum {
+    // document coordinate system (i.e. the one where the 'viewBox' attribute is expressed)
+    DOC_ELEMENT_SPACE_DOCUMENT = 0,
+    // drawing surface coordinate system, according to the current document and surface viewports
+    DOC_ELEMENT_SPACE_SURFACE  = 1
+} DocElementSpace;
+
+// hit-testing modes
+typedef enum {
+    // an element is hit if the point falls within its bounding box
+    DOC_HIT_TEST_BBOX  = 0,
+    // an element is hit if the point falls within one of its painted pixels (fill-rule, stroke and clipping are all honored)
+    DOC_HIT_TEST_EXACT = 1
+} DocHitTestMode;
+
+// a hit-testing result
+typedef struct {
+    // element index
+    SVGTuint elemIdx;
+    // element 'id' attribute, NULL if not present
+    const char* id;
+} DocHitResult;
+
+// returned when a drawing is interrupted because of a deadline (it extends SVGTErrorCode)
+#define DOC_DRAW_CANCELLED_ERROR ((SVGTErrorCode)1000)
+
+// drawing limits, checked before each element is drawn
+typedef struct {
+    // absolute deadline, in the timerNowNs time base (0 means no deadline)
+    uint64_t deadlineNs;
+} DocDrawLimits;
+
+// the state of an incremental drawing (see docElementsDrawStep)
+typedef struct {
+    // index of the next element to draw
+    size_t next;
+    // true when all elements have been drawn
+    SVGTboolean done;
+} DocDrawState;
+
+// the rendering cost of a first-level element
+typedef struct {
+    // element index (within the 'elements' array)
+    SVGTuint elemIdx;
+    // element 'id' attribute, NULL if not present
+    const char* id;
+    // drawing time, in nanoseconds
+    uint64_t ns;
+    // element bounding box on the surface, clipped to it, in pixels: min x, min y, max x, max y (exclusive);
+    // rows are counted from the top of the surface
+    SVGTint bbox[4];
+    // area of the clipped bounding box, in pixels; it is an upper bound of the pixels actually painted
+    // by the element (AmanithSVG does not report the coverage of a draw call)
+    SVGTuint bboxPixels;
+} DocElementCost;
+
+// a node of the bounding volume hierarchy used to accelerate hit-testing
+typedef struct {
+    // node box, in document coordinates: min x, min y, max x, max y
+    SVGTfloat box[4];
+    // leaf nodes: first entry within the 'bvhIndices' array; internal nodes: index of the left child (the right one follows)
+    SVGTuint first;
+    // leaf nodes: number of entries within the 'bvhIndices' array; internal nodes: 0
+    SVGTuint count;
+} DocBVHNode;
+
+// an array of document elements
+DYNARRAY_DECLARE(DocElementDynArray, DocElement)
+// an array of element indices
+DYNARRAY_DECLARE(DocElementIdxDynArray, SVGTuint)
+
+// the index of all first-level elements of an SVG document
+typedef struct {
+    // AmanithSVG document handle
+    SVGTHandle docHandle;
+    // first-level elements, sorted by z-order (i.e. from the bottommost to the topmost)
+    DocElementDynArray elements;
+    // 'id' attribute --> element index (within the 'elements' array)
+    StringHashMap idHashmap;
+    // storage for 'id' attributes, released at once
+    Arena idArena;
+    // document --> packer pixel space transformation: scale x, scale y, translation x, translation y
+    SVGTfloat docToPixel[4];
+    // document viewport and alignment in effect when the elements were packed
+    SVGTfloat packViewport[4];
+    SVGTuint packAlignment[2];
+    // bounding volume hierarchy (built lazily, at the first hit-test)
+    DocBVHNode* bvhNodes;
+    SVGTuint bvhNodesCount;
+    SVGTuint* bvhIndices;
+    // hit-testing candidates (kept across queries, in order to avoid allocations)
+    DocElementIdxDynArray hitCandidates;
+    // 1x1 drawing surface used by exact hit-testing (created lazily, through surfaceCreate)
+    SVGTHandle hitSurface;
+} DocElements;
+
+// build the index of first-level elements of the given document
+// NB: a packing task is performed internally, so this function must not be called while another packing task is still open
+SVGTErrorCode docElementsBuild(DocElements* elems,
+                               const SVGTHandle docHandle);
+
+// release the given elements index
+void docElementsDestroy(DocElements* elems);
+
+// get the amount of memory used by the given elements index, in bytes (the AmanithSVG document is not included)
+size_t docElementsMemoryUsage(const DocElements* elems);
+
+// find the element having the given 'id' attribute, returning its index (a negative number if not found)
+SVGTint docElementFind(DocElements* elems,
+                       const char* id);
+
+// get the bounding box (stroke included) of the specified element: bbox[0] = x, bbox[1] = y, bbox[2] = width, bbox[3] = height
+// bounding boxes are cached when the index is built, so this function never touches the element geometry
+// NB: 'surface' is used by DOC_ELEMENT_SPACE_SURFACE only
+SVGTErrorCode docElementBBox(const DocElements* elems,
+                             const SVGTuint elemIdx,
+                             const DocElementSpace space,
+                             SVGTHandle surface,
+                             SVGTfloat* bbox);
+
+// draw the specified element over the given surface; the element is scaled uniformly and centered in order to fit the whole surface
+SVGTErrorCode docElementDraw(const DocElements* elems,
+                             const SVGTuint elemIdx,
+                             SVGTHandle surface,
+                             const SVGTRenderingQuality renderingQuality);
+
+// show or hide the specified element; the element is marked as dirty only if its visibility actually changes
+SVGTErrorCode docElementVisibilitySet(DocElements* elems,
+                                      const SVGTuint elemIdx,
+                                      const SVGTboolean visible);
+
+// get the surface region covered by dirty elements: rect[0] = x, rect[1] = y, rect[2] = width, rect[3] = height
+// the region is expressed in whole pixels and clipped to the surface; width and height are 0 if nothing is dirty
+SVGTErrorCode docElementsDirtyRect(const DocElements* elems,
+                                   SVGTHandle surface,
+                                   SVGTint* rect);
+
+// draw visible elements, as the whole document would be drawn on 'surface', limiting the drawing to the given region
+// (a NULL region stands for the whole surface); the region is drawn at the top/left corner of 'dstSurface' (that can be
+// 'surface' itself, when the region is NULL); dirty flags are cleared only for the elements whose box (clipped to the surface)
+// lies entirely within the region, so that changes outside of it are still reported by the next docElementsDirtyRect
+// NB: 'dstSurface' is not cleared; elements are placed exactly where svgtDocDraw would place them (AmanithSVG packed rectangles
+// path may still round a few isolated pixels differently, by one unit at most), unless the document viewport (or its alignment)
+// has been changed after docElementsBuild or the surface viewport origin is not integer: in such cases elements are placed at
+// whole pixel positions, so they could differ from svgtDocDraw by a sub-pixel offset
+SVGTErrorCode docElementsRegionDraw(DocElements* elems,
+                                    SVGTHandle surface,
+                                    const SVGTint* region,
+                                    SVGTHandle dstSurface,
+                                    const SVGTRenderingQuality renderingQuality);
+
+// draw visible elements on 'surface' (as docElementsRegionDraw does, with a NULL region), checking the given limits before each
+// element; if a limit is reached, DOC_DRAW_CANCELLED_ERROR is returned and the surface is left in its partially drawn state,
+// otherwise the surface content equals the one of docElementsRegionDraw
+// NB: the granularity is the first-level element, a single element can not be interrupted
+SVGTErrorCode docElementsDrawLimited(DocElements* elems,
+                                     SVGTHandle surface,
+                                     const SVGTRenderingQuality renderingQuality,
+                                     const DocDrawLimits* limits);
+
+// initialize the state of an incremental drawing
+void docDrawStateInit(DocDrawState* state);
+
+// perform a step of an incremental drawing of visible elements on 'surface': elements are drawn, starting from where the
+// previous step stopped, until the given time budget runs out (at least one element is drawn by each step); once all
+// elements have been drawn 'state->done' is set, and the surface content equals the one of docElementsRegionDraw
+// NB: neither the surface nor the elements visibility must be changed between steps
+SVGTErrorCode docElementsDrawStep(DocElements* elems,
+                                  SVGTHandle surface,
+                                  const SVGTRenderingQuality renderingQuality,
+                                  const SVGTuint budgetMicros,
+                                  DocDrawState* state);
+
+// draw visible elements on 'surface' (as docElementsRegionDraw does, with a NULL region), measuring the cost of each one;
+// 'costs' must have room for all elements, the number of written entries (i.e. visible elements) is returned through
+// 'costsCount', and entries are sorted from the most expensive to the cheapest
+SVGTErrorCode docElementsCostReport(DocElements* elems,
+                                    SVGTHandle surface,
+                                    const SVGTRenderingQuality renderingQuality,
+                                    DocElementCost* costs,
+                                    SVGTuint* costsCount);
+
+// find the elements under the given point, expressed in surface coordinates; hit elements are returned from the topmost to the bottommost
+// at most 'maxResults' entries are written within the 'results' array, and their number is returned through 'resultsCount'
+SVGTErrorCode docHitTest(DocElements* elems,
+                         SVGTHandle surface,
+                         const SVGTfloat x,
+                         const SVGTfloat y,
+                         const DocHitTestMode mode,
+                         DocHitResult* results,
+                         const SVGTuint maxResults,
+                         SVGTuint* resultsCount);
+
+#endif /* DOC_ELEMENTS_H */
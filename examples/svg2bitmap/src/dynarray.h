@@ -47,6 +47,7 @@
 */
 
 #include <stdlib.h>
+#include "allocator.h"
 
 /************************************************************
                       Dynamic arrays
@@ -67,7 +68,7 @@
 
 // array initialization, with initial allocation too
 #define DYNARRAY_INIT_ALLOCATE(_dynArray, _itemTypeName, _capacity) \
-    (_dynArray).data = calloc((_capacity), sizeof(_itemTypeName)); \
+    (_dynArray).data = memCalloc((_capacity), sizeof(_itemTypeName)); \
     if ((_dynArray).data != NULL) { \
         (_dynArray).capacity = (_capacity); \
     } \
@@ -79,13 +80,13 @@
 // array destruction
 #define DYNARRAY_DESTROY(_dynArray) \
     if ((_dynArray).data != NULL) { \
-        free((_dynArray).data); \
+        memFree((_dynArray).data); \
     }
 
 // push an element at the end of a dynamic array; if space is not enought, the array is expanded by additional 64 elements
 #define DYNARRAY_PUSH_BACK(_dynArray, _itemTypeName, _val) \
     if ((_dynArray).size >= (_dynArray).capacity) { \
-        _itemTypeName* tmpData = (_itemTypeName *)realloc((_dynArray).data, ((_dynArray).capacity + 64) * sizeof(_itemTypeName)); \
+        _itemTypeName* tmpData = (_itemTypeName *)memRealloc((_dynArray).data, ((_dynArray).capacity + 64) * sizeof(_itemTypeName)); \
         if (tmpData != NULL) { \
             (_dynArray).data = tmpData; \
             (_dynArray).capacity += 64; \
@@ -142,6 +142,30 @@ void extractFileExt(char* fileExt,
     }
 }
 
+// tell if the given extension is present within the given list (extensions are separated by semicolon, e.g. "svg;svgz")
+static SVGTboolean fileExtMatch(const char* fileExt,
+                                const char* filter) {
+
+    SVGTboolean found = SVGT_FALSE;
+
+    while ((*filter != '\0') && (!found)) {
+
+        const size_t len = strcspn(filter, ";");
+        const char* end = filter + len;
+
+        if (len < _MAX_EXT) {
+            char ext[_MAX_EXT];
+            (void)memcpy(ext, filter, len);
+            ext[len] = '\0';
+            found = (strCaseCmp(fileExt, ext) == 0) ? SVGT_TRUE : SVGT_FALSE;
+        }
+        // skip the separator
+        filter = (*end == ';') ? (end + 1) : end;
+    }
+
+    return found;
+}
+
 // scan a directory, searching for files
 SVGTboolean scanPath(FileSearchResult* searchResult,
                      const FileSearchSettings* searchSettings,
@@ -189,7 +213,7 @@ SVGTboolean scanPath(FileSearchResult* searchResult,
                     // extract file extension
                     extractFileExt(fileExt, data.cFileName);
                     // if the file extension does not match the filter, do not output a new entry
-                    if (strCaseCmp(fileExt, searchSettings->fileExtFilter) != 0) {
+                    if (!fileExtMatch(fileExt, searchSettings->fileExtFilter)) {
                         fileFound = SVGT_FALSE;
                     }
                 }
@@ -245,7 +269,7 @@ SVGTboolean scanPath(FileSearchResult* searchResult,
                     // extract file extension
                     extractFileExt(fileExt, rc->d_name);
                     // if the file extension does not match the filter, do not output a new entry
-                    if (strCaseCmp(fileExt, searchSettings->fileExtFilter) != 0) {
+                    if (!fileExtMatch(fileExt, searchSettings->fileExtFilter)) {
                         fileFound = SVGT_FALSE;
                     }
                 }
@@ -382,14 +406,14 @@ SVGTubyte* loadFile(const char* fileName,
         return NULL;
     }
 
-    if ((buffer = calloc(size + padAmount, sizeof(SVGTubyte))) == NULL) {
+    if ((buffer = memCalloc(size + padAmount, sizeof(SVGTubyte))) == NULL) {
         (void)fclose(fp);
         return NULL;
     }
 
     // read the file content and store it within the memory buffer
     if ((read = fread(buffer, sizeof(SVGTubyte), size, fp)) != size) {
-        free(buffer);
+        memFree(buffer);
         (void)fclose(fp);
         return NULL;
     }
@@ -94,7 +94,8 @@ typedef struct {
     SVGTboolean scanRecursively;
     // SVGT_TRUE = add path to returned file names, SVGT_FALSE = do not add path to returned file names
     SVGTboolean addPath;
-    // an optional filter, if non NULL only files that match this file extension will be added to the output list
+    // an optional filter, if non NULL only files that match one of these file extensions (separated by semicolon,
+    // e.g. "svg;svgz") will be added to the output list
     const char* fileExtFilter;
 } FileSearchSettings;
 
@@ -0,0 +1,320 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file gzip_utils.c
+    \brief Gzip (e.g. .svgz) utilities, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include <string.h>
+/* miniz implementation is compiled within png_utils.c, here we need its declarations only */
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_ARCHIVE_APIS
+#define MINIZ_NO_TIME
+#define MINIZ_NO_ZLIB_APIS
+#define MINIZ_HEADER_FILE_ONLY
+#include "miniz.c"
+#include "file_utils.h"
+#include "gzip_utils.h"
+
+// size of the chunks the compressed stream is read in
+#define GZIP_CHUNK_SIZE 65536U
+// maximum compression ratio achievable by deflate (a 258 bytes match every 2 bits, roughly)
+#define GZIP_MAX_RATIO 1032U
+
+// header flags (RFC 1952)
+#define GZIP_FLAG_HCRC     0x02U
+#define GZIP_FLAG_EXTRA    0x04U
+#define GZIP_FLAG_NAME     0x08U
+#define GZIP_FLAG_COMMENT  0x10U
+#define GZIP_FLAG_RESERVED 0xE0U
+
+// open a file for reading
+static FILE* gzipFileOpen(const char* fileName) {
+
+    FILE* fp = NULL;
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1400)
+    // make Microsoft Visual Studio happy
+    if (fopen_s(&fp, fileName, "rb") != 0) {
+        fp = NULL;
+    }
+#else
+    fp = fopen(fileName, "rb");
+#endif
+
+    return fp;
+}
+
+// read a 32bit little endian value
+static SVGTuint le32Read(const SVGTubyte* p) {
+
+    return (SVGTuint)p[0] | ((SVGTuint)p[1] << 8) | ((SVGTuint)p[2] << 16) | ((SVGTuint)p[3] << 24);
+}
+
+// skip a zero-terminated string
+static SVGTboolean zeroTerminatedSkip(FILE* fp) {
+
+    int c;
+
+    do {
+        c = fgetc(fp);
+    } while ((c != EOF) && (c != 0));
+
+    return (c == 0) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// skip the gzip header, leaving the file positioned at the beginning of the deflate stream
+static SVGTboolean gzipHeaderSkip(FILE* fp) {
+
+    SVGTubyte header[10];
+    // magic number, deflate compression method, no reserved flags
+    SVGTboolean ok = ((fread(header, 1U, 10U, fp) == 10U) && (header[0] == 0x1FU) && (header[1] == 0x8BU) &&
+                      (header[2] == 8U) && ((header[3] & GZIP_FLAG_RESERVED) == 0U)) ? SVGT_TRUE : SVGT_FALSE;
+
+    if (ok && ((header[3] & GZIP_FLAG_EXTRA) != 0U)) {
+        SVGTubyte extraLen[2];
+        ok = ((fread(extraLen, 1U, 2U, fp) == 2U) && (fseek(fp, (long)extraLen[0] | ((long)extraLen[1] << 8), SEEK_CUR) == 0)) ? SVGT_TRUE : SVGT_FALSE;
+    }
+    if (ok && ((header[3] & GZIP_FLAG_NAME) != 0U)) {
+        ok = zeroTerminatedSkip(fp);
+    }
+    if (ok && ((header[3] & GZIP_FLAG_COMMENT) != 0U)) {
+        ok = zeroTerminatedSkip(fp);
+    }
+    if (ok && ((header[3] & GZIP_FLAG_HCRC) != 0U)) {
+        ok = (fseek(fp, 2, SEEK_CUR) == 0) ? SVGT_TRUE : SVGT_FALSE;
+    }
+
+    return ok;
+}
+
+// inflate the deflate stream read from the given file into '*out', a buffer of 'capacity' bytes (plus padding) that
+// grows as data is inflated, so that the declared size is just an hint; the buffer never grows beyond 'maxSize' bytes,
+// the most that the stream can inflate to (once the input is over, the inflator reads zero bits instead of failing, so
+// truncated data could inflate endlessly); the inflated size is returned through 'outSize', and the file is left
+// positioned just after the deflate stream
+static SVGTErrorCode gzipInflate(FILE* fp,
+                                 tinfl_decompressor* inflator,
+                                 SVGTubyte* in,
+                                 size_t capacity,
+                                 const size_t maxSize,
+                                 const SVGTuint padAmount,
+                                 SVGTubyte** out,
+                                 size_t* outSize) {
+
+    size_t inAvail = 0U;
+    size_t inPos = 0U;
+    size_t outPos = 0U;
+    SVGTboolean eof = SVGT_FALSE;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    tinfl_status status = TINFL_STATUS_FAILED;
+    SVGTubyte* buffer = memMalloc(capacity + padAmount);
+
+    if (buffer != NULL) {
+
+        tinfl_init(inflator);
+        do {
+            size_t inBytes, outBytes;
+
+            // read the next chunk
+            if (inPos == inAvail) {
+                inAvail = fread(in, 1U, GZIP_CHUNK_SIZE, fp);
+                inPos = 0U;
+                eof = (inAvail < GZIP_CHUNK_SIZE) ? SVGT_TRUE : SVGT_FALSE;
+            }
+            // grow the output buffer, if full
+            if (outPos == capacity) {
+                const size_t newCapacity = MIN(MAX(capacity * 2U, GZIP_CHUNK_SIZE), maxSize);
+                if (newCapacity > capacity) {
+                    SVGTubyte* newBuffer = memRealloc(buffer, newCapacity + padAmount);
+                    if (newBuffer != NULL) {
+                        buffer = newBuffer;
+                        capacity = newCapacity;
+                    }
+                    else {
+                        err = SVGT_OUT_OF_MEMORY_ERROR;
+                    }
+                }
+                else {
+                    // more output than the stream can hold, data is corrupted or truncated
+                    err = SVGT_INVALID_RESOURCE_ERROR;
+                }
+            }
+            if (err == SVGT_NO_ERROR) {
+                inBytes = inAvail - inPos;
+                outBytes = capacity - outPos;
+                // the output buffer holds the whole content, so it acts as the dictionary too (the buffer base
+                // can change between calls, because only offsets are kept within the inflator state)
+                status = tinfl_decompress(inflator, in + inPos, &inBytes, buffer, buffer + outPos, &outBytes,
+                                          TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF | (eof ? 0U : TINFL_FLAG_HAS_MORE_INPUT));
+                inPos += inBytes;
+                outPos += outBytes;
+            }
+        } while ((err == SVGT_NO_ERROR) && ((status == TINFL_STATUS_NEEDS_MORE_INPUT) || (status == TINFL_STATUS_HAS_MORE_OUTPUT)));
+
+        if (err == SVGT_NO_ERROR) {
+            if (status != TINFL_STATUS_DONE) {
+                err = SVGT_INVALID_RESOURCE_ERROR;
+            }
+            else
+            // rewind to the end of the deflate stream (i.e. the beginning of the trailer): the inflator does not give
+            // back the whole bytes that it has already loaded into its bit buffer, beyond the end of the stream
+            if (fseek(fp, -(long)((inAvail - inPos) + (inflator->m_num_bits >> 3)), SEEK_CUR) != 0) {
+                err = SVGT_INVALID_RESOURCE_ERROR;
+            }
+        }
+
+        if (err == SVGT_NO_ERROR) {
+            *out = buffer;
+            *outSize = outPos;
+        }
+        else {
+            memFree(buffer);
+        }
+    }
+    else {
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    return err;
+}
+
+// tell if the given file starts with the gzip magic number
+SVGTboolean gzipFileCheck(const char* fileName) {
+
+    SVGTboolean result = SVGT_FALSE;
+    FILE* fp = gzipFileOpen(fileName);
+
+    if (fp != NULL) {
+        SVGTubyte magic[2];
+        result = ((fread(magic, 1U, 2U, fp) == 2U) && (magic[0] == 0x1FU) && (magic[1] == 0x8BU)) ? SVGT_TRUE : SVGT_FALSE;
+        (void)fclose(fp);
+    }
+
+    return result;
+}
+
+// load a gzip file in memory, inflating its content
+SVGTubyte* gzipFileLoad(const char* fileName,
+                        const SVGTuint padAmount,
+                        size_t* fileSize,
+                        SVGTErrorCode* err) {
+
+    SVGTubyte* result = NULL;
+    FILE* fp = gzipFileOpen(fileName);
+
+    *err = SVGT_INVALID_RESOURCE_ERROR;
+    if (fp != NULL) {
+
+        // the last 8 bytes should be the trailer of the (only) member: CRC-32 and size (modulo 2^32) of the original content
+        SVGTubyte trailer[8];
+
+        if ((fseek(fp, -8, SEEK_END) == 0) && (fread(trailer, 1U, 8U, fp) == 8U)) {
+
+            const long compressedSize = ftell(fp);
+            // the declared size is used as the initial capacity only, it can not exceed the maximum deflate ratio
+            const size_t maxSize = ((size_t)compressedSize <= (((size_t)-1) / GZIP_MAX_RATIO)) ? ((size_t)compressedSize * GZIP_MAX_RATIO) : ((size_t)-1);
+            const size_t capacity = MIN((size_t)le32Read(&trailer[4]), maxSize);
+            SVGTubyte* in = memMalloc(GZIP_CHUNK_SIZE);
+            tinfl_decompressor* inflator = memMalloc(sizeof(tinfl_decompressor));
+
+            if ((in == NULL) || (inflator == NULL)) {
+                *err = SVGT_OUT_OF_MEMORY_ERROR;
+            }
+            else
+            if ((fseek(fp, 0, SEEK_SET) == 0) && gzipHeaderSkip(fp)) {
+
+                SVGTubyte* buffer;
+                size_t size;
+
+                if ((*err = gzipInflate(fp, inflator, in, capacity, maxSize, padAmount, &buffer, &size)) == SVGT_NO_ERROR) {
+
+                    SVGTubyte magic[2];
+
+                    // check the trailer that actually follows the deflate stream
+                    if ((fread(trailer, 1U, 8U, fp) != 8U) || ((SVGTuint)size != le32Read(&trailer[4])) ||
+                        ((SVGTuint)mz_crc32(MZ_CRC32_INIT, buffer, size) != le32Read(trailer))) {
+                        *err = SVGT_INVALID_RESOURCE_ERROR;
+                    }
+                    else
+                    // another member follows (i.e. concatenated gzip streams)
+                    if ((fread(magic, 1U, 2U, fp) == 2U) && (magic[0] == 0x1FU) && (magic[1] == 0x8BU)) {
+                        *err = GZIP_MULTI_MEMBER_ERROR;
+                    }
+
+                    if (*err == SVGT_NO_ERROR) {
+                        // zero the padding
+                        (void)memset(&buffer[size], 0, padAmount);
+                        *fileSize = size;
+                        result = buffer;
+                    }
+                    else {
+                        memFree(buffer);
+                    }
+                }
+            }
+            memFree(inflator);
+            memFree(in);
+        }
+        (void)fclose(fp);
+    }
+
+    return result;
+}
+
+// load an external file in memory, transparently inflating gzip compressed content
+SVGTubyte* loadFileInflated(const char* fileName,
+                            const SVGTuint padAmount,
+                            size_t* fileSize,
+                            SVGTErrorCode* err) {
+
+    SVGTubyte* result;
+
+    if (gzipFileCheck(fileName)) {
+        result = gzipFileLoad(fileName, padAmount, fileSize, err);
+    }
+    else {
+        result = loadFile(fileName, padAmount, fileSize);
+        *err = (result != NULL) ? SVGT_NO_ERROR : SVGT_INVALID_RESOURCE_ERROR;
+    }
+
+    return result;
+}
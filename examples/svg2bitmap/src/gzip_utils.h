@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef GZIP_UTILS_H
+#define GZIP_UTILS_H
+
+/*!
+    \file gzip_utils.h
+    \brief Gzip (e.g. .svgz) utilities, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// tell if the given file starts with the gzip magic number
+SVGTboolean gzipFileCheck(const char* fileName);
+
+// error code used when a gzip file contains more than one member (i.e. concatenated gzip streams), that is not supported
+#define GZIP_MULTI_MEMBER_ERROR ((SVGTErrorCode)1002)
+
+// load a gzip file (single member) in memory, inflating its content; the compressed stream is read in chunks and
+// inflated directly into the returned buffer, that grows as needed (the size declared by the trailer is just used as
+// an initial capacity, bounded by the maximum deflate ratio); NULL is returned, along with an error code, if the file
+// cannot be read (SVGT_INVALID_RESOURCE_ERROR), it is not a valid gzip file or its content does not match the trailer
+// (SVGT_INVALID_RESOURCE_ERROR), memory is exhausted (SVGT_OUT_OF_MEMORY_ERROR), or it contains more than one
+// member (GZIP_MULTI_MEMBER_ERROR)
+SVGTubyte* gzipFileLoad(const char* fileName,
+                        const SVGTuint padAmount,
+                        size_t* fileSize,
+                        SVGTErrorCode* err);
+
+// load an external file in memory, transparently inflating gzip compressed content (see loadFile and gzipFileLoad)
+SVGTubyte* loadFileInflated(const char* fileName,
+                            const SVGTuint padAmount,
+                            size_t* fileSize,
+                            SVGTErrorCode* err);
+
+#endif /* GZIP_UTILS_H */
@@ -45,9 +45,15 @@
 
 #include "arg_parser.h"
 #include "file_utils.h"
+#include "gzip_utils.h"
 #include "str_utils.h"
 #include "rendering.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "svg_library.h"
+#include "theme.h"
 #include <limits.h>
+#include <stdint.h>
 #if defined(_DEBUG)
     #include <assert.h>
 #endif
@@ -232,6 +238,41 @@ static SVGTboolean amanithsvgInit(const CommandArguments* args,
     return ok;
 }
 
+// load the shared libraries of definitions
+static SVGTboolean librariesLoad(CommandArguments* args) {
+
+    SVGTboolean ok = SVGT_TRUE;
+
+    for (size_t i = 0U; (i < args->libraries.size) && ok; ++i) {
+
+        SvgLibrary* library = &args->libraries.data[i];
+        const SVGTErrorCode err = svgLibraryLoad(library, args->compact);
+
+        if (err == SVGT_NO_ERROR) {
+            LOG_INFO_EXT("- library %.128s loaded from %.400s (%u definitions)\n", library->name.name, library->fileName.name, (SVGTuint)library->defs.size);
+        }
+        else
+        if (err == GZIP_MULTI_MEMBER_ERROR) {
+            LOG_ERROR_EXT("\nunable to load library %s, it contains multiple gzip members (concatenated streams), that are not supported\n", library->fileName.name);
+            ok = SVGT_FALSE;
+        }
+        else {
+            LOG_ERROR_EXT("\nunable to load library %s (error code = %d)\n", library->fileName.name, err);
+            ok = SVGT_FALSE;
+        }
+    }
+
+    return ok;
+}
+
+// release the shared libraries of definitions
+static void librariesDestroy(CommandArguments* args) {
+
+    for (size_t i = 0U; i < args->libraries.size; ++i) {
+        svgLibraryDestroy(&args->libraries.data[i]);
+    }
+}
+
 // release AmanithSVG and external resources (fonts and images)
 static void amanithsvgDestroy(const CommandArguments* args,
                               ExternalResourceDynArray* fontResources,
@@ -242,13 +283,13 @@ static void amanithsvgDestroy(const CommandArguments* args,
 
     // release in-memory fonts
     for (size_t i = 0U; i < fontResources->size; ++i) {
-        free((void*)fontResources->data[i].buffer);
+        memFree((void*)fontResources->data[i].buffer);
     }
     DYNARRAY_DESTROY(*fontResources)
 
     // release in-memory images
     for (size_t i = 0U; i < imageResources->size; ++i) {
-        free((void*)imageResources->data[i].buffer);
+        memFree((void*)imageResources->data[i].buffer);
     }
     DYNARRAY_DESTROY(*imageResources)
 
@@ -357,14 +398,14 @@ static argparse_error cbInput(argparse* self,
         err = ARG_PARSE_CALLBACK_ERROR;
     }
     else {
-        // if the given 'inputPath' is a regular file, check its extension (it must be "svg")
+        // if the given 'inputPath' is a regular file, check its extension (it must be "svg" or "svgz")
         if (fileExists(args->inputDir.name)) {
             char fileExt[_MAX_EXT];
             // extract file extension
             extractFileExt(fileExt, args->inputDir.name);
-            // it must be "svg"
-            if (strCaseCmp(fileExt, "svg") != 0) {
-                LOG_ERROR_EXT("\ninput file '%s' must have a .svg extension\n\n", input);
+            // it must be "svg" or "svgz" (gzip compressed)
+            if ((strCaseCmp(fileExt, "svg") != 0) && (strCaseCmp(fileExt, "svgz") != 0)) {
+                LOG_ERROR_EXT("\ninput file '%s' must have a .svg or .svgz extension\n\n", input);
                 err = ARG_PARSE_CALLBACK_ERROR;
             }
         }
@@ -597,6 +638,223 @@ static argparse_error cbScale(argparse* self,
     return err;
 }
 
+// callback for setting the element to render
+static argparse_error cbElement(argparse* self,
+                                const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    const char* id = option->value.string;
+#if defined(_DEBUG)
+    assert((id != NULL) && (*id != '\0'));
+#endif
+
+    (void)self;
+
+    // copy element id
+    args->elementId = id;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for enabling the compaction of SVG files
+static argparse_error cbCompact(argparse* self,
+                                const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->compact = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for setting the theme (i.e. style overrides)
+static argparse_error cbTheme(argparse* self,
+                              const argparse_option* option) {
+
+    argparse_error err = ARG_PARSE_NO_ERROR;
+    CommandArguments* args = (CommandArguments*)option->data;
+    const char* overrides = option->value.string;
+
+    (void)self;
+
+    if (themeOverridesValid(overrides)) {
+        args->theme = overrides;
+    }
+    else {
+        LOG_ERROR_EXT("\ninvalid theme: %s (the expected format is key=value,key=value,... with at most %u entries)\n\n", overrides, THEME_MAX_OVERRIDES);
+        err = ARG_PARSE_CALLBACK_ERROR;
+    }
+
+    return err;
+}
+
+// callback for adding a shared library of definitions
+static argparse_error cbLibrary(argparse* self,
+                                const argparse_option* option) {
+
+    argparse_error err = ARG_PARSE_NO_ERROR;
+    CommandArguments* args = (CommandArguments*)option->data;
+    const char* fileName = option->value.string;
+    SvgLibrary library;
+
+    (void)self;
+
+    svgLibraryInit(&library, fileName);
+    if (!fileExists(library.fileName.name)) {
+        LOG_ERROR_EXT("\nlibrary file %s does not exist\n\n", library.fileName.name);
+        err = ARG_PARSE_CALLBACK_ERROR;
+    }
+
+    // documents reference libraries by name, so names must be unique
+    for (size_t i = 0U; (i < args->libraries.size) && (err == ARG_PARSE_NO_ERROR); ++i) {
+        if (strcmp(args->libraries.data[i].name.name, library.name.name) == 0) {
+            LOG_ERROR_EXT("\nthe library name %.128s is used by both %.400s and %.400s\n\n", library.name.name, args->libraries.data[i].fileName.name, library.fileName.name);
+            err = ARG_PARSE_CALLBACK_ERROR;
+        }
+    }
+
+    if (err == ARG_PARSE_NO_ERROR) {
+        // the library will be loaded just before rendering
+        DYNARRAY_PUSH_BACK(args->libraries, SvgLibrary, library)
+    }
+
+    return err;
+}
+
+// callback for setting the elements to hide
+static argparse_error cbHide(argparse* self,
+                             const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    const char* ids = option->value.string;
+#if defined(_DEBUG)
+    assert((ids != NULL) && (*ids != '\0'));
+#endif
+
+    (void)self;
+
+    // copy the list of element ids
+    args->hiddenIds = ids;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for setting the hit-test point
+static argparse_error cbHitTest(argparse* self,
+                                const argparse_option* option) {
+
+    SVGTuint i = 0U;
+    argparse_error err = ARG_PARSE_NO_ERROR;
+    const char* params = option->value.string;
+    size_t len = strlen(option->value.string);
+    // arguments structure, whose fields will be written
+    CommandArguments* args = (CommandArguments*)option->data;
+
+    (void)self;
+
+    // we must read two or three parameters: <x>, <y> [, <mode>]
+    while ((*params != '\0') && (i < 3U) && (err == ARG_PARSE_NO_ERROR)) {
+
+        const char* valueStart = skipSpaces(params, &len);
+        char* valueEnd = (char*)skipUntilChar(valueStart, &len, ',');
+
+        if (*valueEnd == ',') {
+            // overwrite comma with a '\0', so that 'valueStart' now points to a null-termined string
+            *valueEnd = '\0';
+            // skip comma
+            valueEnd++;
+        }
+
+        switch (i) {
+            case 0:
+            case 1:
+                // point coordinates, in output pixels
+                if ((err = argparse_float(valueStart, &args->hitTestPoint[i])) != ARG_PARSE_NO_ERROR) {
+                    LOG_ERROR_EXT("\nmalformed hit-test coordinate: %s\n\n", valueStart);
+                }
+                break;
+            case 2:
+            default:
+                // hit-test mode
+                if (strCaseCmp(valueStart, "exact") == 0) {
+                    args->hitTestExact = SVGT_TRUE;
+                }
+                else
+                if (strCaseCmp(valueStart, "bbox") == 0) {
+                    args->hitTestExact = SVGT_FALSE;
+                }
+                else {
+                    LOG_ERROR_EXT("\ninvalid hit-test mode: %s (valid values are 'exact' and 'bbox')\n\n", valueStart);
+                    err = ARG_PARSE_CALLBACK_ERROR;
+                }
+                break;
+        }
+
+        // next parameter
+        i++;
+        params = valueEnd;
+    }
+
+    if ((err == ARG_PARSE_NO_ERROR) && (i < 2U)) {
+        LOG_ERROR("\nhit-test requires both x and y coordinates\n\n");
+        err = ARG_PARSE_CALLBACK_ERROR;
+    }
+    args->hitTest = (err == ARG_PARSE_NO_ERROR) ? SVGT_TRUE : SVGT_FALSE;
+
+    return err;
+}
+
+// callback for setting the complexity limits of input files
+static argparse_error cbLimits(argparse* self,
+                               const argparse_option* option) {
+
+    SVGTuint i = 0U;
+    argparse_error err = ARG_PARSE_NO_ERROR;
+    const char* params = option->value.string;
+    size_t len = strlen(option->value.string);
+    // arguments structure, whose fields will be written
+    CommandArguments* args = (CommandArguments*)option->data;
+    // limits in the same order they are specified
+    SVGTuint* limits[5] = {
+        &args->parseLimits.maxElements,
+        &args->parseLimits.maxUseInstances,
+        &args->parseLimits.maxPathSegments,
+        &args->parseLimits.maxDepth,
+        &args->parseLimits.maxFilterPixels
+    };
+
+    (void)self;
+
+    // we can read up to five parameters: <elements>, <use instances>, <path segments>, <depth>, <filter pixels>
+    while ((*params != '\0') && (i < 5U) && (err == ARG_PARSE_NO_ERROR)) {
+
+        SVGTint v;
+        const char* valueStart = skipSpaces(params, &len);
+        char* valueEnd = (char*)skipUntilChar(valueStart, &len, ',');
+
+        if (*valueEnd == ',') {
+            // overwrite comma with a '\0', so that 'valueStart' now points to a null-termined string
+            *valueEnd = '\0';
+            // skip comma
+            valueEnd++;
+        }
+
+        if ((argparse_int(valueStart, &v) != ARG_PARSE_NO_ERROR) || (checkParsedInteger(v, SVGT_FALSE, 0, INT_MAX) != ARG_PARSE_NO_ERROR)) {
+            LOG_ERROR_EXT("\nmalformed limit: %s (limits must be non-negative numbers, where 0 means no limit)\n\n", valueStart);
+            err = ARG_PARSE_CALLBACK_ERROR;
+        }
+        else {
+            *limits[i] = (SVGTuint)v;
+        }
+
+        // next parameter
+        i++;
+        params = valueEnd;
+    }
+
+    return err;
+}
+
 // callback for setting rendering quality
 static argparse_error cbRenderingQuality(argparse* self,
                                          const argparse_option* option) {
@@ -673,6 +931,161 @@ static argparse_error cbPixelFormat(argparse* self,
     return err;
 }
 
+// callback for setting the drawing deadline
+static argparse_error cbDeadline(argparse* self,
+                                 const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    argparse_error err = checkParsedInteger(option->value.int_number, SVGT_FALSE, 1, INT_MAX);
+
+    (void)self;
+
+    if (err != ARG_PARSE_NO_ERROR) {
+        LOG_ERROR("\ndeadline must be a positive number of milliseconds\n\n");
+    }
+    else {
+        // copy the value
+        args->deadline = (SVGTuint)option->value.int_number;
+    }
+
+    return err;
+}
+
+// callback for setting the incremental drawing budget
+static argparse_error cbDrawBudget(argparse* self,
+                                   const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    argparse_error err = checkParsedInteger(option->value.int_number, SVGT_FALSE, 1, INT_MAX);
+
+    (void)self;
+
+    if (err != ARG_PARSE_NO_ERROR) {
+        LOG_ERROR("\ndraw budget must be a positive number of microseconds\n\n");
+    }
+    else {
+        // copy the value
+        args->drawBudget = (SVGTuint)option->value.int_number;
+    }
+
+    return err;
+}
+
+// callback for enabling document statistics
+static argparse_error cbDocStats(argparse* self,
+                                 const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->docStats = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for enabling the cost report
+static argparse_error cbCostReport(argparse* self,
+                                   const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->costReport = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for enabling memory statistics
+static argparse_error cbMemoryStats(argparse* self,
+                                    const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->memoryStats = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for enabling the profiler
+static argparse_error cbProfile(argparse* self,
+                                const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->profile = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for enabling the profiler zones check
+static argparse_error cbProfileCheck(argparse* self,
+                                     const argparse_option* option) {
+
+    ((CommandArguments*)option->data)->profileCheck = option->value.bool_value;
+
+    (void)self;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for setting the trace file
+static argparse_error cbTrace(argparse* self,
+                              const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    const char* fileName = option->value.string;
+#if defined(_DEBUG)
+    assert((fileName != NULL) && (*fileName != '\0'));
+#endif
+
+    (void)self;
+
+    // copy the file name
+    args->traceFileName = fileName;
+
+    return ARG_PARSE_NO_ERROR;
+}
+
+// callback for setting the memory limit
+static argparse_error cbMemoryLimit(argparse* self,
+                                    const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    // the limit is converted to bytes, so it must fit a size_t (i.e. 4095 megabytes on 32-bit platforms)
+    const SVGTint maxMegabytes = ((SIZE_MAX / (1024U * 1024U)) < (size_t)INT_MAX) ? (SVGTint)(SIZE_MAX / (1024U * 1024U)) : INT_MAX;
+    argparse_error err = checkParsedInteger(option->value.int_number, SVGT_FALSE, 1, maxMegabytes);
+
+    (void)self;
+
+    if (err != ARG_PARSE_NO_ERROR) {
+        LOG_ERROR_EXT("\nmemory limit must be a positive number of megabytes, not greater than %d\n\n", maxMegabytes);
+    }
+    else {
+        // copy the value
+        args->memoryLimit = (SVGTuint)option->value.int_number;
+    }
+
+    return err;
+}
+
+// callback for setting the number of benchmark iterations
+static argparse_error cbBenchmark(argparse* self,
+                                  const argparse_option* option) {
+
+    CommandArguments* args = (CommandArguments*)option->data;
+    argparse_error err = checkParsedInteger(option->value.int_number, SVGT_FALSE, 1, INT_MAX);
+
+    (void)self;
+
+    if (err != ARG_PARSE_NO_ERROR) {
+        LOG_ERROR("\nbenchmark iterations must be a positive number\n\n");
+    }
+    else {
+        // copy the value
+        args->benchmarkIterations = (SVGTuint)option->value.int_number;
+    }
+
+    return err;
+}
+
 // callback for setting compression level
 static argparse_error cbCompressionLevel(argparse* self,
                                          const argparse_option* option) {
@@ -1058,30 +1471,179 @@ static argparse_error cbAtlasInput(argparse* self,
 /************************************************************
                        main program
 ************************************************************/
+// reject combinations of drawing modes that can not be honored together
+static SVGTboolean argumentsCheck(const CommandArguments* args) {
+
+    SVGTboolean ok = SVGT_FALSE;
+
+    if (args->costReport && (args->drawBudget > 0U)) {
+        LOG_ERROR("\n--cost-report and --draw-budget cannot be used together\n\n");
+    }
+    else
+    if (args->costReport && (args->deadline > 0U)) {
+        LOG_ERROR("\n--cost-report and --deadline cannot be used together\n\n");
+    }
+    else
+    if ((args->drawBudget > 0U) && (args->deadline > 0U)) {
+        LOG_ERROR("\n--draw-budget and --deadline cannot be used together\n\n");
+    }
+    else
+    if ((args->hiddenIds != NULL) && (args->elementId != NULL)) {
+        LOG_ERROR("\n--hide and --element cannot be used together\n\n");
+    }
+    else {
+        ok = SVGT_TRUE;
+    }
+
+    return ok;
+}
+
+// maximum nesting of profiler zones tracked by the zones check
+#define ZONES_CHECK_MAX_DEPTH 16
+
+// the state of the profiler zones check (see --profile-check)
+typedef struct {
+    // number of begun and ended zones, for each phase
+    SVGTuint begun[PROFILE_PHASES_COUNT];
+    SVGTuint ended[PROFILE_PHASES_COUNT];
+    // phases of the currently open zones, from the outermost to the innermost
+    ProfilePhase open[ZONES_CHECK_MAX_DEPTH];
+    SVGTuint depth;
+    // number of zones not ended in the reverse order they were begun (unknown zones and overflows included)
+    SVGTuint mismatches;
+} ZonesCheck;
+
+// get the phase of the given zone (zone names are the static strings returned by profilePhaseName)
+static SVGTint zonePhase(const char* zoneName) {
+
+    SVGTint result = -1;
+
+    for (SVGTint i = 0; (i < (SVGTint)PROFILE_PHASES_COUNT) && (result < 0); ++i) {
+        if (zoneName == profilePhaseName((ProfilePhase)i)) {
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+// profiler hook: a zone begins
+static void zonesCheckBegin(const char* zoneName,
+                            void* userData) {
+
+    ZonesCheck* check = (ZonesCheck*)userData;
+    const SVGTint phase = zonePhase(zoneName);
+
+    if ((phase < 0) || (check->depth >= ZONES_CHECK_MAX_DEPTH)) {
+        check->mismatches++;
+    }
+    else {
+        check->begun[phase]++;
+        check->open[check->depth++] = (ProfilePhase)phase;
+    }
+}
+
+// profiler hook: a zone ends
+static void zonesCheckEnd(const char* zoneName,
+                          void* userData) {
+
+    ZonesCheck* check = (ZonesCheck*)userData;
+    const SVGTint phase = zonePhase(zoneName);
+
+    // the ended zone must be the innermost open one
+    if ((phase < 0) || (check->depth == 0U) || (check->open[check->depth - 1U] != (ProfilePhase)phase)) {
+        check->mismatches++;
+    }
+    else {
+        check->ended[phase]++;
+        check->depth--;
+    }
+}
+
+// verify that zones are balanced, and that they agree with the accumulated timings of the profiler
+static SVGTboolean zonesCheckReport(const CommandArguments* args,
+                                    const ZonesCheck* check) {
+
+    Profile profile;
+    SVGTuint zonesCount = 0U;
+    SVGTboolean ok = ((check->depth == 0U) && (check->mismatches == 0U)) ? SVGT_TRUE : SVGT_FALSE;
+
+    profileGet(&profile);
+    for (SVGTuint i = 0U; i < PROFILE_PHASES_COUNT; ++i) {
+        if ((check->begun[i] != check->ended[i]) || (check->ended[i] != profile.count[i])) {
+            ok = SVGT_FALSE;
+        }
+        zonesCount += check->ended[i];
+    }
+
+    if (ok) {
+        LOG_INFO_EXT("- Profiler zones balanced (%u zones)\n", zonesCount);
+    }
+    else {
+        LOG_ERROR_EXT("- Profiler zones not balanced (%u zones, %u still open, %u mismatches)\n", zonesCount, check->depth, check->mismatches);
+    }
+
+    return ok;
+}
+
 static SVGTboolean svg2Bitmap(CommandArguments* args) {
 
     SVGTboolean ok;
     ExternalResourceDynArray fontResources = { 0 };
     ExternalResourceDynArray imageResources = { 0 };
+    ZonesCheck zonesCheck;
+
+    // apply the memory limit, if any
+    memLimitSet((size_t)args->memoryLimit * 1024U * 1024U);
+    // enable per-phase timings, if requested (the zones check compares them against its own counters)
+    profilerEnable((args->profile || args->profileCheck) ? SVGT_TRUE : SVGT_FALSE);
+    profileReset();
+    if (args->profileCheck) {
+        (void)memset(&zonesCheck, 0, sizeof(ZonesCheck));
+        (void)profilerHooksSet(zonesCheckBegin, zonesCheckEnd, &zonesCheck);
+    }
+    if ((args->traceFileName != NULL) && (!traceBegin(args->traceFileName))) {
+        LOG_WARNING_EXT("- unable to create trace file %s, tracing disabled\n", args->traceFileName);
+    }
 
     // initialize AmanithSVG library and load resources
     if ((ok = amanithsvgInit(args, &fontResources, &imageResources))) {
 
-        if (args->atlasInputs.size > 0U) {
-            // atlas generation
-            ok = svg2BitmapAtlas(args, &fontResources, &imageResources);
+        // load shared libraries of definitions, if any
+        if ((ok = librariesLoad(args))) {
+            if (args->atlasInputs.size > 0U) {
+                // atlas generation
+                ok = svg2BitmapAtlas(args, &fontResources, &imageResources);
+            }
+            else
+            if (args->benchmarkIterations > 0U) {
+                // parsing benchmark of single or multiple SVG files (nothing is rendered)
+                ok = svg2BitmapBenchmark(args);
+            }
+            else {
+                // rendering of single or multiple SVG files (i.e. one PNG image will be produced for each rendered file)
+                ok = svg2BitmapFile(args);
+            }
+        }
+
+        if (args->profile) {
+            profileLog(args);
         }
-        else {
-            // rendering of single or multiple SVG files (i.e. one PNG image will be produced for each rendered file)
-            ok = svg2BitmapFile(args);
+        if (args->profileCheck) {
+            (void)profilerHooksSet(NULL, NULL, NULL);
+            ok = (zonesCheckReport(args, &zonesCheck) && ok) ? SVGT_TRUE : SVGT_FALSE;
         }
 
-        // release AmanithSVG library and resources
+        // release shared libraries, AmanithSVG library and resources
+        librariesDestroy(args);
         amanithsvgDestroy(args, &fontResources, &imageResources);
 
         LOG_INFO("- Done\n");
     }
 
+    // close the trace file, if any
+    traceEnd();
+
     return ok;
 }
 
@@ -1114,6 +1676,23 @@ int main(int argc,
         OPT_INTEGER('\0', "output-width", "set the output width, in pixel; a negative number will cause the value to be taken directly from the SVG file(s)", cbOutputWidth, &prgArgs),
         OPT_INTEGER('\0', "output-height", "set the output height, in pixel; a negative number will cause the value to be taken directly from the SVG file(s)", cbOutputHeight, &prgArgs),
         OPT_FLOAT  ('\0', "scale", "additional scale to be applied to all SVG files (also in atlas mode), must be a positive number; default is 1.0", cbScale, &prgArgs),
+        OPT_STRING ('\0', "element", "render only the first-level element having the given 'id' attribute; the output is sized according to the element bounding box", cbElement, &prgArgs),
+        OPT_BOOLEAN('\0', "compact", "remove comments, metadata (<metadata>, <title>, <desc>), editor data and blank text from SVG files before parsing, reporting the reclaimed bytes", cbCompact, &prgArgs),
+        OPT_STRING ('\0', "theme", "style overrides applied to all SVG files, in the format key=value,key=value,... where each key is a color (e.g. red, #FF0000), currentColor or a CSS custom property (e.g. --accent); e.g. 'currentColor=#202020,--accent=orange'", cbTheme, &prgArgs),
+        OPT_STRING ('\0', "library", "a shared library of definitions (gradients, patterns, symbols, ...) referenced by SVG files as 'name#id', where name is the library file name without extension (e.g. href=\"icons#star\" or fill=\"url(icons#sky)\" for icons.svg); referenced definitions are copied into each SVG file before parsing; it can be repeated", cbLibrary, &prgArgs),
+        OPT_STRING ('\0', "hide", "a list of first-level element ids (separated by comma) to hide; the document is drawn element by element, and the region touched by hidden elements is reported", cbHide, &prgArgs),
+        OPT_STRING ('\0', "hit-test", "report the first-level elements under the given output pixel, from the topmost to the bottommost; format is: <x>,<y>[,<mode: exact (default) / bbox>]; e.g. '120,45,exact'", cbHitTest, &prgArgs),
+        OPT_STRING ('\0', "limits", "reject untrusted SVG files that exceed the given complexity limits, checked before parsing: <max elements>,<max elements instantiated by <use> references>,<max path segments>,<max nesting depth>,<max filter pixels (filter primitives times output pixels, checked before drawing)>; 0 or a missing value means no limit; e.g. '100000,50000,1000000,64'", cbLimits, &prgArgs),
+        OPT_INTEGER('\0', "deadline", "drawing deadline for each SVG file, in milliseconds; the document is drawn element by element and, once the deadline is exceeded, drawing stops and the partial result is written (exit code is failure); if the deadline is not exceeded, the result matches the plain drawing", cbDeadline, &prgArgs),
+        OPT_INTEGER('\0', "draw-budget", "draw each SVG file incrementally, in steps that last (at most) the given number of microseconds each (at least one first-level element is drawn per step); the number of steps is reported, and the result matches the plain drawing", cbDrawBudget, &prgArgs),
+        OPT_BOOLEAN('\0', "doc-stats", "report complexity statistics of each SVG file before parsing it: elements by type, path segments, text runs, filter primitives, nesting depth", cbDocStats, &prgArgs),
+        OPT_BOOLEAN('\0', "cost-report", "draw each SVG file element by element, reporting the first-level elements that are most expensive to draw (time and bounding box pixels), and writing a cost heatmap as <output name>-heatmap.png", cbCostReport, &prgArgs),
+        OPT_BOOLEAN('\0', "memory-stats", "report the memory used by each rendered file: drawing surface, elements index, XML buffer and tool heap, drawing surfaces included (current, peak, live blocks, allocations)", cbMemoryStats, &prgArgs),
+        OPT_INTEGER('\0', "memory-limit", "heap memory limit, in megabytes; allocations (drawing surfaces included) that would exceed it fail with an out of memory error; default is no limit", cbMemoryLimit, &prgArgs),
+        OPT_BOOLEAN('\0', "profile", "report the time spent in each processing phase (load, parse, index, pack, draw, encode, write) at the end", cbProfile, &prgArgs),
+        OPT_BOOLEAN('\0', "profile-check", "debug: install counting zone hooks on the profiler and check, at the end, that zones are balanced and agree with the per-phase counts (exit code is failure otherwise)", cbProfileCheck, &prgArgs),
+        OPT_STRING ('\0', "trace", "write a trace of processing phases (load, parse, index, pack, draw, encode, write) to the given JSON file, in the Chrome trace event format (chrome://tracing, Perfetto)", cbTrace, &prgArgs),
+        OPT_INTEGER('\0', "benchmark", "do not render: parse and destroy each input SVG file the given number of times, reporting average/minimum times, scanning/parsing throughput, and the time spent copying first-level element ids within an arena versus a heap allocation per id", cbBenchmark, &prgArgs),
         OPT_INTEGER('\0', "rendering-quality", "rendering quality, must be a number between 1 and 100 (where 100 represents the best quality)", cbRenderingQuality, &prgArgs),
         OPT_STRING ('\0', "filter", "optional post-rendering filter, valid values are: 'none' (default), 'dilate'", cbFilter, &prgArgs),
         OPT_STRING ('\0', "pixel-format", "pixel format of produced PNG, valid values are: 'rgba' (default), 'bgra'", cbPixelFormat, &prgArgs),
@@ -1125,7 +1704,7 @@ int main(int argc,
         OPT_BOOLEAN( 'q', "quiet", "quiet mode, it disables information messages and warnings", cbQuiet, &prgArgs),
         // mandatory arguments
         OPT_GROUP("ARGS:\n\n"),
-        OPT_STRING ( 'i', "input", "a list of SVG files (separated by comma), or an input path that will be scanned, looking for SVG files", cbInput, &prgArgs),
+        OPT_STRING ( 'i', "input", "a list of SVG files (separated by comma), or an input path that will be scanned, looking for SVG files (.svg, and gzip compressed .svgz)", cbInput, &prgArgs),
         OPT_END()
     };
     SVGTint exitCode = EXIT_FAILURE;
@@ -1148,8 +1727,10 @@ int main(int argc,
     if ((argsErr = argparse_parse(&argsParser, argc, (const char**)argv)) == ARG_PARSE_NO_ERROR) {
 
         if ((strlen(prgArgs.inputDir.name) > 0) || (prgArgs.atlasInputs.size > 0U)) {
-            // do the real conversion
-            exitCode = svg2Bitmap(&prgArgs) ? EXIT_SUCCESS : EXIT_FAILURE;
+            // reject conflicting options, then do the real conversion
+            if (argumentsCheck(&prgArgs)) {
+                exitCode = svg2Bitmap(&prgArgs) ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
         }
         else {
             // the mandatory --input argument has not been provided, print usage
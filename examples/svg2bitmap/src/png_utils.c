@@ -82,6 +82,37 @@ static SVGTuint crc32Miniz(const SVGTubyte* buffer,
     return ~crcu32;
 }
 
+// output callback for the deflate encoder; it behaves like miniz tdefl_output_buffer_putter, but the
+// buffer grows through memRealloc (miniz would call the plain C runtime realloc on a block that has been
+// allocated by memMalloc)
+static mz_bool pngOutputPutter(const void* buffer,
+                               int len,
+                               void* user) {
+
+    mz_bool ok = MZ_TRUE;
+    tdefl_output_buffer* outBuffer = (tdefl_output_buffer*)user;
+    const size_t newSize = outBuffer->m_size + (size_t)len;
+
+    if (newSize > outBuffer->m_capacity) {
+        size_t newCapacity = outBuffer->m_capacity;
+        mz_uint8* newBuffer;
+        // double the capacity until the new data fits
+        do {
+            newCapacity = MZ_MAX(128U, newCapacity << 1U);
+        } while (newSize > newCapacity);
+        if ((ok = ((newBuffer = (mz_uint8*)memRealloc(outBuffer->m_pBuf, newCapacity)) != NULL))) {
+            outBuffer->m_pBuf = newBuffer;
+            outBuffer->m_capacity = newCapacity;
+        }
+    }
+    if (ok) {
+        (void)memcpy(&outBuffer->m_pBuf[outBuffer->m_size], buffer, (size_t)len);
+        outBuffer->m_size = newSize;
+    }
+
+    return ok;
+}
+
 // this is actually a modification of Alex's original code so PNG files generated by this function pass pngcheck
 static void* pngWriteMiniz(size_t* outSize,
                            const SVGTubyte* pixels,
@@ -99,7 +130,7 @@ static void* pngWriteMiniz(size_t* outSize,
     static const SVGTubyte pngColorChans[] = { 0x00, 0x00, 0x04, 0x02, 0x06 };
     static const SVGTuint pngProbes[11] = { 0, 1, 6, 32, 16, 32, 128, 256, 512, 768, 1500 };
     // the deflate encoder (miniz)
-    tdefl_compressor* minizCompressor = (tdefl_compressor*)calloc(1, sizeof(tdefl_compressor));
+    tdefl_compressor* minizCompressor = (tdefl_compressor*)memCalloc(1, sizeof(tdefl_compressor));
 
     if (minizCompressor != NULL) {
         // PNG header
@@ -144,7 +175,7 @@ static void* pngWriteMiniz(size_t* outSize,
         const SVGTuint textCommentChunkLen = 7 + 1 + commentLen;
         // IDAT CRC, description (tEXt chunk), comment (tEXt chunk), IEND chunk
         const SVGTuint pngFooterSize = 4 + (8 + textDescriptionChunkLen + 4) + (8 + textCommentChunkLen + 4) + (8 + 4);
-        SVGTubyte* pngFooter = (SVGTubyte*)calloc(pngFooterSize, sizeof(SVGTubyte));
+        SVGTubyte* pngFooter = (SVGTubyte*)memCalloc(pngFooterSize, sizeof(SVGTubyte));
 
         if (pngFooter != NULL) {
 
@@ -156,7 +187,7 @@ static void* pngWriteMiniz(size_t* outSize,
             outBuffer.m_pBuf = NULL;
             outBuffer.m_expandable = MZ_TRUE;
             outBuffer.m_capacity = (pngHeaderSize + pngFooterSize) + MAX(64U, (1U + bpl) * height);
-            if ((outBuffer.m_pBuf = (SVGTubyte*)malloc(outBuffer.m_capacity * sizeof(SVGTubyte))) != NULL) {
+            if ((outBuffer.m_pBuf = (SVGTubyte*)memMalloc(outBuffer.m_capacity * sizeof(SVGTubyte))) != NULL) {
 
                 SVGTuint y, z;
                 const SVGTint pitch = (verticalFlip ? (-(SVGTint)width) : (SVGTint)width);
@@ -164,11 +195,11 @@ static void* pngWriteMiniz(size_t* outSize,
 
                 // write dummy header
                 for (z = pngHeaderSize; z != 0U; --z) {
-                    tdefl_output_buffer_putter(&z, 1, &outBuffer);
+                    pngOutputPutter(&z, 1, &outBuffer);
                 }
 
                 // initialize deflate encoding
-                tdefl_init(minizCompressor, tdefl_output_buffer_putter, &outBuffer, pngProbes[MIN(10U, compressionLevel)] | TDEFL_WRITE_ZLIB_HEADER);
+                tdefl_init(minizCompressor, pngOutputPutter, &outBuffer, pngProbes[MIN(10U, compressionLevel)] | TDEFL_WRITE_ZLIB_HEADER);
                 // loop over scanlines
                 for (y = height; y != 0; --y) {
                     // filter type (0 = no filter)
@@ -281,8 +312,8 @@ static void* pngWriteMiniz(size_t* outSize,
                     pngFooter[j++] = 0x82;
 
                     // write footer
-                    if (!tdefl_output_buffer_putter(pngFooter, pngFooterSize, &outBuffer)) {
-                        free(outBuffer.m_pBuf);
+                    if (!pngOutputPutter(pngFooter, pngFooterSize, &outBuffer)) {
+                        memFree(outBuffer.m_pBuf);
                     }
                     else {
                         // compute final size of file
@@ -291,12 +322,12 @@ static void* pngWriteMiniz(size_t* outSize,
                     }
                 }
                 else {
-                    free(outBuffer.m_pBuf);
+                    memFree(outBuffer.m_pBuf);
                 }
             }
-            free(pngFooter);
+            memFree(pngFooter);
         }
-        free(minizCompressor);
+        memFree(minizCompressor);
     }
 
     return result;
@@ -334,6 +365,6 @@ void pngDestroy(void* pngData) {
 
     if (pngData != NULL) {
         // free allocated memory
-        mz_free(pngData);
+        memFree(pngData);
     }
 }
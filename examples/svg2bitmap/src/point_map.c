@@ -0,0 +1,213 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file point_map.c
+    \brief Batch mapping of points between document and surface viewports, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "point_map.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define POINT_MAP_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define POINT_MAP_NEON
+#endif
+
+// invert the given affine matrix, returning SVGT_FALSE if it is singular
+SVGTboolean pointMapMatrixInvert(const SVGTfloat* m,
+                                 SVGTfloat* inv) {
+
+    SVGTboolean ok = SVGT_FALSE;
+    const SVGTfloat det = (m[0] * m[3]) - (m[1] * m[2]);
+
+    if (det != 0.0f) {
+        const SVGTfloat a = m[3] / det;
+        const SVGTfloat b = -m[1] / det;
+        const SVGTfloat c = -m[2] / det;
+        const SVGTfloat d = m[0] / det;
+        const SVGTfloat tx = -((a * m[4]) + (c * m[5]));
+        const SVGTfloat ty = -((b * m[4]) + (d * m[5]));
+
+        // 'inv' and 'm' can be the same array
+        inv[0] = a;
+        inv[1] = b;
+        inv[2] = c;
+        inv[3] = d;
+        inv[4] = tx;
+        inv[5] = ty;
+        ok = SVGT_TRUE;
+    }
+
+    return ok;
+}
+
+// get the affine matrix that maps document points into surface points, or vice versa
+SVGTErrorCode pointMapMatrix(const SVGTHandle docHandle,
+                             SVGTHandle surface,
+                             const SVGTboolean inverse,
+                             SVGTfloat* m) {
+
+    SVGTErrorCode err;
+    SVGTfloat docViewport[4];
+    SVGTfloat surfaceViewport[4];
+    SVGTuint alignment[2];
+
+    // the matrix is built from the viewports, in double precision: sampling svgtPointMap and differencing the
+    // results would lose all precision when the document viewport origin is far from zero
+    if (((err = svgtDocViewportGet(docHandle, docViewport)) == SVGT_NO_ERROR) &&
+        ((err = svgtDocViewportAlignmentGet(docHandle, alignment)) == SVGT_NO_ERROR) &&
+        ((err = svgtSurfaceViewportGet(surface, surfaceViewport)) == SVGT_NO_ERROR)) {
+
+        if ((docViewport[2] <= 0.0f) || (docViewport[3] <= 0.0f) || (surfaceViewport[2] <= 0.0f) || (surfaceViewport[3] <= 0.0f)) {
+            // degenerate viewport
+            err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+        }
+        else {
+            double sx = (double)surfaceViewport[2] / (double)docViewport[2];
+            double sy = (double)surfaceViewport[3] / (double)docViewport[3];
+            double offsetX = 0.0;
+            double offsetY = 0.0;
+            double tx, ty;
+
+            if (alignment[0] != SVGT_ASPECT_RATIO_ALIGN_NONE) {
+                // uniform scale; alignments are ordered as xMin, xMid, xMax within yMin, yMid, yMax
+                const double s = (alignment[1] == SVGT_ASPECT_RATIO_SLICE) ? MAX(sx, sy) : MIN(sx, sy);
+                const double alignX = (double)((alignment[0] - 1U) % 3U) * 0.5;
+                const double alignY = (double)((alignment[0] - 1U) / 3U) * 0.5;
+                offsetX = ((double)surfaceViewport[2] - ((double)docViewport[2] * s)) * alignX;
+                offsetY = ((double)surfaceViewport[3] - ((double)docViewport[3] * s)) * alignY;
+                sx = s;
+                sy = s;
+            }
+            // the document viewport origin is mapped onto the (aligned) surface viewport origin
+            tx = (double)surfaceViewport[0] + offsetX - ((double)docViewport[0] * sx);
+            ty = (double)surfaceViewport[1] + offsetY - ((double)docViewport[1] * sy);
+
+            m[1] = 0.0f;
+            m[2] = 0.0f;
+            if (inverse) {
+                m[0] = (SVGTfloat)(1.0 / sx);
+                m[3] = (SVGTfloat)(1.0 / sy);
+                m[4] = (SVGTfloat)(-tx / sx);
+                m[5] = (SVGTfloat)(-ty / sy);
+            }
+            else {
+                m[0] = (SVGTfloat)sx;
+                m[3] = (SVGTfloat)sy;
+                m[4] = (SVGTfloat)tx;
+                m[5] = (SVGTfloat)ty;
+            }
+        }
+    }
+
+    return err;
+}
+
+// transform 'count' points (interleaved x, y pairs) by the given matrix
+void pointMapTransform(const SVGTfloat* m,
+                       const SVGTfloat* src,
+                       SVGTfloat* dst,
+                       const SVGTuint count) {
+
+    SVGTuint i = 0U;
+
+#if defined(POINT_MAP_SSE2)
+    // two points per iteration: (x0, y0, x1, y1)
+    const __m128 ab = _mm_setr_ps(m[0], m[1], m[0], m[1]);
+    const __m128 cd = _mm_setr_ps(m[2], m[3], m[2], m[3]);
+    const __m128 t = _mm_setr_ps(m[4], m[5], m[4], m[5]);
+
+    for (; (i + 2U) <= count; i += 2U) {
+
+        const __m128 p = _mm_loadu_ps(&src[i * 2U]);
+        // (x0, x0, x1, x1) and (y0, y0, y1, y1)
+        const __m128 xx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128 yy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+
+        _mm_storeu_ps(&dst[i * 2U], _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, ab), _mm_mul_ps(yy, cd)), t));
+    }
+#elif defined(POINT_MAP_NEON)
+    // four points per iteration, de-interleaved into x and y lanes
+    for (; (i + 4U) <= count; i += 4U) {
+
+        float32x4x2_t p = vld2q_f32(&src[i * 2U]);
+        float32x4x2_t q;
+
+        q.val[0] = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[4]), p.val[0], m[0]), p.val[1], m[2]);
+        q.val[1] = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[5]), p.val[0], m[1]), p.val[1], m[3]);
+        vst2q_f32(&dst[i * 2U], q);
+    }
+#endif
+
+    // scalar path (and remaining points)
+    for (; i < count; ++i) {
+
+        const SVGTfloat x = src[i * 2U];
+        const SVGTfloat y = src[(i * 2U) + 1U];
+
+        dst[i * 2U] = (m[0] * x) + (m[2] * y) + m[4];
+        dst[(i * 2U) + 1U] = (m[1] * x) + (m[3] * y) + m[5];
+    }
+}
+
+// map 'count' points (interleaved x, y pairs) from the document viewport to the surface viewport, or vice versa
+SVGTErrorCode pointMapBatch(const SVGTHandle docHandle,
+                            SVGTHandle surface,
+                            const SVGTfloat* src,
+                            SVGTfloat* dst,
+                            const SVGTuint count,
+                            const SVGTboolean inverse) {
+
+    SVGTErrorCode err;
+    SVGTfloat m[6];
+
+    if ((src == NULL) || (dst == NULL)) {
+        err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+    }
+    else
+    if ((err = pointMapMatrix(docHandle, surface, inverse, m)) == SVGT_NO_ERROR) {
+        pointMapTransform(m, src, dst, count);
+    }
+
+    return err;
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef POINT_MAP_H
+#define POINT_MAP_H
+
+/*!
+    \file point_map.h
+    \brief Batch mapping of points between document and surface viewports, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// get the affine matrix (2x3, column-major: a, b, c, d, tx, ty) that maps document points into surface points
+// (inverse = SVGT_FALSE), or surface points into document points (inverse = SVGT_TRUE); the matrix takes into
+// account the current document viewport (and its alignment) and the current surface viewport
+SVGTErrorCode pointMapMatrix(const SVGTHandle docHandle,
+                             SVGTHandle surface,
+                             const SVGTboolean inverse,
+                             SVGTfloat* m);
+
+// invert the given affine matrix, returning SVGT_FALSE if it is singular; 'inv' and 'm' can be the same array
+SVGTboolean pointMapMatrixInvert(const SVGTfloat* m,
+                                 SVGTfloat* inv);
+
+// transform 'count' points (interleaved x, y pairs) by the given matrix; 'src' and 'dst' can be the same array
+void pointMapTransform(const SVGTfloat* m,
+                       const SVGTfloat* src,
+                       SVGTfloat* dst,
+                       const SVGTuint count);
+
+// map 'count' points (interleaved x, y pairs) from the document viewport to the surface viewport (inverse = SVGT_FALSE),
+// or vice versa (inverse = SVGT_TRUE); it is the batch counterpart of svgtPointMap
+SVGTErrorCode pointMapBatch(const SVGTHandle docHandle,
+                            SVGTHandle surface,
+                            const SVGTfloat* src,
+                            SVGTfloat* dst,
+                            const SVGTuint count,
+                            const SVGTboolean inverse);
+
+#endif /* POINT_MAP_H */
@@ -0,0 +1,243 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file profiler.c
+    \brief Per-phase timing counters, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "profiler.h"
+#include "timer.h"
+
+// phase names, indexed by ProfilePhase
+static const char* profilePhaseNames[PROFILE_PHASES_COUNT] = {
+    "load",
+    "parse",
+    "index",
+    "pack",
+    "draw",
+    "encode",
+    "write"
+};
+
+// accumulated timings
+static SVGTboolean profilerEnabled = SVGT_FALSE;
+static Profile profile = { { 0U }, { 0U } };
+// trace file (NULL if tracing is not active), its time origin and the number of written events
+static FILE* traceFile = NULL;
+static uint64_t traceOrigin = 0U;
+static SVGTuint traceEventsCount = 0U;
+// zone callbacks
+static ProfilerZoneBeginFunc hookBeginZone = NULL;
+static ProfilerZoneEndFunc hookEndZone = NULL;
+static void* hookUserData = NULL;
+// true if phases must be tracked, i.e. if the profiler is enabled, a trace is active or hooks are set
+static SVGTboolean profilerActive = SVGT_FALSE;
+
+// update the 'profilerActive' flag
+static void profilerActiveUpdate(void) {
+
+    profilerActive = (profilerEnabled || (traceFile != NULL) || (hookBeginZone != NULL)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// write a complete ("X") trace event
+static void traceEventWrite(const ProfilePhase phase,
+                            const uint64_t begin,
+                            const uint64_t end,
+                            const SVGTHandle docHandle,
+                            const SVGTint elementsCount) {
+
+    // timestamps and durations are expressed in microseconds
+    (void)fprintf(traceFile, "%s{\"name\":\"%s\",\"cat\":\"svg2bitmap\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f",
+                  (traceEventsCount > 0U) ? ",\n" : "", profilePhaseNames[phase],
+                  (double)(begin - traceOrigin) / 1000.0, (double)(end - begin) / 1000.0);
+    if ((docHandle != SVGT_INVALID_HANDLE) || (elementsCount >= 0)) {
+        (void)fprintf(traceFile, ",\"args\":{");
+        if (docHandle != SVGT_INVALID_HANDLE) {
+            (void)fprintf(traceFile, "\"doc\":%u%s", docHandle, (elementsCount >= 0) ? "," : "");
+        }
+        if (elementsCount >= 0) {
+            (void)fprintf(traceFile, "\"elements\":%d", elementsCount);
+        }
+        (void)fprintf(traceFile, "}");
+    }
+    (void)fprintf(traceFile, "}");
+    traceEventsCount++;
+}
+
+// set the zone callbacks
+SVGTErrorCode profilerHooksSet(ProfilerZoneBeginFunc beginZone,
+                               ProfilerZoneEndFunc endZone,
+                               void* userData) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    if ((beginZone == NULL) != (endZone == NULL)) {
+        err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+    }
+    else {
+        hookBeginZone = beginZone;
+        hookEndZone = endZone;
+        hookUserData = userData;
+        profilerActiveUpdate();
+    }
+
+    return err;
+}
+
+// enable or disable the profiler
+void profilerEnable(const SVGTboolean enabled) {
+
+    profilerEnabled = enabled;
+    profilerActiveUpdate();
+}
+
+// mark the beginning of a phase
+uint64_t profileBegin(const ProfilePhase phase) {
+
+    uint64_t result = 0U;
+
+    if (profilerActive) {
+        if (hookBeginZone != NULL) {
+            hookBeginZone(profilePhaseNames[phase], hookUserData);
+        }
+        result = timerNowNs();
+    }
+
+    return result;
+}
+
+// mark the end of a phase, accumulating its duration
+void profileEnd(const ProfilePhase phase,
+                const uint64_t begin) {
+
+    profileEndExt(phase, begin, SVGT_INVALID_HANDLE, -1);
+}
+
+// mark the end of a phase, specifying the involved document and elements count for the trace
+void profileEndExt(const ProfilePhase phase,
+                   const uint64_t begin,
+                   const SVGTHandle docHandle,
+                   const SVGTint elementsCount) {
+
+    if (profilerActive) {
+
+        const uint64_t end = timerNowNs();
+
+        if (profilerEnabled) {
+            profile.ns[phase] += end - begin;
+            profile.count[phase]++;
+        }
+        if (traceFile != NULL) {
+            traceEventWrite(phase, begin, end, docHandle, elementsCount);
+        }
+        if (hookEndZone != NULL) {
+            hookEndZone(profilePhaseNames[phase], hookUserData);
+        }
+    }
+}
+
+// start writing a trace file, in the Chrome trace event format
+SVGTboolean traceBegin(const char* fileName) {
+
+    SVGTboolean ok = SVGT_FALSE;
+
+    // only one trace at a time
+    if ((traceFile == NULL) && ((traceFile = fopen(fileName, "wb")) != NULL)) {
+        (void)fprintf(traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        (void)fprintf(traceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"svg2bitmap\"}}");
+        traceOrigin = timerNowNs();
+        // the metadata event has been written
+        traceEventsCount = 1U;
+        profilerActiveUpdate();
+        ok = SVGT_TRUE;
+    }
+
+    return ok;
+}
+
+// stop writing the trace file, closing it
+void traceEnd(void) {
+
+    if (traceFile != NULL) {
+        (void)fprintf(traceFile, "\n]}\n");
+        (void)fclose(traceFile);
+        traceFile = NULL;
+        profilerActiveUpdate();
+    }
+}
+
+// get the accumulated timings
+void profileGet(Profile* result) {
+
+    *result = profile;
+}
+
+// reset the accumulated timings
+void profileReset(void) {
+
+    (void)memset(&profile, 0, sizeof(Profile));
+}
+
+// get the (static) name of the given phase
+const char* profilePhaseName(const ProfilePhase phase) {
+
+    return ((SVGTuint)phase < PROFILE_PHASES_COUNT) ? profilePhaseNames[phase] : "unknown";
+}
+
+// log the accumulated timings
+void profileLog(const CommandArguments* args) {
+
+    SVGTuint i;
+    uint64_t total = 0U;
+
+    for (i = 0U; i < PROFILE_PHASES_COUNT; ++i) {
+        total += profile.ns[i];
+    }
+
+    LOG_INFO("- Profile (phase, count, total, average, share)\n");
+    for (i = 0U; i < PROFILE_PHASES_COUNT; ++i) {
+        if (profile.count[i] > 0U) {
+            const double totalMs = (double)profile.ns[i] / 1000000.0;
+            LOG_INFO_EXT("    %-8s %6u %11.3f ms %11.3f ms %6.1f%%\n", profilePhaseNames[i], profile.count[i], totalMs,
+                         totalMs / (double)profile.count[i], (total > 0U) ? ((100.0 * (double)profile.ns[i]) / (double)total) : 0.0);
+        }
+    }
+}
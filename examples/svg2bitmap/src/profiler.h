@@ -0,0 +1,128 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*!
+    \file profiler.h
+    \brief Per-phase timing counters, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+#include <stdint.h>
+
+// the phases whose time is accumulated by the profiler
+typedef enum {
+    // file loading (including compaction and theming)
+    PROFILE_PHASE_LOAD = 0,
+    // XML parsing, i.e. svgtDocCreate
+    PROFILE_PHASE_PARSE = 1,
+    // first-level elements index
+    PROFILE_PHASE_INDEX = 2,
+    // packing of atlas elements
+    PROFILE_PHASE_PACK = 3,
+    // rendering on drawing surfaces
+    PROFILE_PHASE_DRAW = 4,
+    // PNG encoding
+    PROFILE_PHASE_ENCODE = 5,
+    // output file writing
+    PROFILE_PHASE_WRITE = 6,
+    PROFILE_PHASES_COUNT = 7
+} ProfilePhase;
+
+// accumulated timings
+typedef struct {
+    // total time spent in each phase, in nanoseconds
+    uint64_t ns[PROFILE_PHASES_COUNT];
+    // number of times each phase has been executed
+    SVGTuint count[PROFILE_PHASES_COUNT];
+} Profile;
+
+// zone callbacks, invoked around each phase; 'zoneName' is a static string (see profilePhaseName), so it
+// can be used directly as a zone identifier by external profilers (e.g. Tracy, Unity Profiler)
+typedef void (*ProfilerZoneBeginFunc)(const char* zoneName,
+                                      void* userData);
+typedef void (*ProfilerZoneEndFunc)(const char* zoneName,
+                                    void* userData);
+
+// set the zone callbacks (NULL to remove them); both callbacks must be specified, so that zones are always balanced
+SVGTErrorCode profilerHooksSet(ProfilerZoneBeginFunc beginZone,
+                               ProfilerZoneEndFunc endZone,
+                               void* userData);
+
+// enable or disable the profiler (it is disabled by default)
+void profilerEnable(const SVGTboolean enabled);
+
+// mark the beginning of a phase, returning the value to be passed to profileEnd; when the
+// profiler is disabled, it costs a branch only
+uint64_t profileBegin(const ProfilePhase phase);
+
+// mark the end of a phase, accumulating its duration
+void profileEnd(const ProfilePhase phase,
+                const uint64_t begin);
+
+// mark the end of a phase, specifying the involved document and elements count (negative if not
+// meaningful); they are written as arguments of the trace event
+void profileEndExt(const ProfilePhase phase,
+                   const uint64_t begin,
+                   const SVGTHandle docHandle,
+                   const SVGTint elementsCount);
+
+// start writing a trace file in the Chrome trace event format (it can be opened by chrome://tracing
+// and Perfetto), one event for each phase; it returns SVGT_FALSE if the file can not be created
+SVGTboolean traceBegin(const char* fileName);
+
+// stop writing the trace file, closing it
+void traceEnd(void);
+
+// get the accumulated timings
+void profileGet(Profile* profile);
+
+// reset the accumulated timings
+void profileReset(void);
+
+// get the (static) name of the given phase
+const char* profilePhaseName(const ProfilePhase phase);
+
+// log the accumulated timings, one line for each executed phase
+void profileLog(const CommandArguments* args);
+
+#endif /* PROFILER_H */
@@ -44,13 +44,24 @@
 */
 
 #include "atlas_export.h"
+#include "doc_elements.h"
+#include "gzip_utils.h"
 #include "png_utils.h"
 #include "str_utils.h"
+#include "svg_compact.h"
+#include "svg_library.h"
+#include "svg_scan.h"
+#include "theme.h"
+#include "profiler.h"
+#include "timer.h"
 #include "rendering.h"
 #include <math.h>
 
 static const char* defaultUnassignedIdName = DEFAULT_ATLAS_EMPTY_ELEMENTS_ID;
 
+// maximum number of elements listed by the cost report
+#define COST_REPORT_MAX_ELEMENTS 10U
+
 // a simple rectangle structure
 typedef struct {
     SVGTuint width;
@@ -66,11 +77,77 @@ static SVGTint roundInteger(const SVGTfloat v) {
 /************************************************************
                   SVG rendering (utilities)
 ************************************************************/
-static char* loadXml(const char* fileName) {
+// true if the first-level elements index must be built
+static SVGTboolean elementsIndexNeeded(const CommandArguments* args) {
+
+    return ((args->elementId != NULL) || (args->hiddenIds != NULL) || args->hitTest || args->costReport ||
+            (args->deadline > 0U) || (args->drawBudget > 0U)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+static char* loadXml(const char* fileName,
+                     const CommandArguments* args) {
 
     size_t fileSize;
-    // add a trailing '\0'
-    return (char*)loadFile(fileName, 1U, &fileSize);
+    SVGTErrorCode loadErr;
+    const uint64_t t = profileBegin(PROFILE_PHASE_LOAD);
+    // add a trailing '\0' (gzip compressed files, e.g. .svgz, are inflated)
+    char* xml = (char*)loadFileInflated(fileName, 1U, &fileSize, &loadErr);
+
+    if (loadErr == GZIP_MULTI_MEMBER_ERROR) {
+        LOG_ERROR_EXT("\n%s contains multiple gzip members (concatenated streams), that are not supported\n", fileName);
+    }
+
+    // remove content not needed for drawing
+    if ((xml != NULL) && args->compact) {
+        const size_t reclaimed = svgCompact(xml, SVG_COMPACT_ALL);
+        // give back the unused memory
+        char* shrunkXml = memRealloc(xml, (fileSize - reclaimed) + 1U);
+        if (shrunkXml != NULL) {
+            xml = shrunkXml;
+        }
+        LOG_INFO_EXT("- %s compacted (%u of %u bytes reclaimed)\n", fileName, (SVGTuint)reclaimed, (SVGTuint)fileSize);
+    }
+
+    // resolve references to shared libraries, if any
+    if ((xml != NULL) && (args->libraries.size > 0U)) {
+
+        char* linkedXml;
+        SVGTuint references;
+        SVGTErrorCode err = svgLibrariesApply(xml, &args->libraries, &linkedXml, &references);
+
+        if (err == SVGT_NO_ERROR) {
+            if (references > 0U) {
+                LOG_INFO_EXT("- %s linked to shared libraries (%u references)\n", fileName, references);
+            }
+            memFree(xml);
+            xml = linkedXml;
+        }
+        else {
+            // go ahead with the original content
+            LOG_WARNING_EXT("- failed to resolve shared library references of %s (error code = %d)\n", fileName, err);
+        }
+    }
+
+    // apply style overrides, if any
+    if ((xml != NULL) && (args->theme != NULL)) {
+
+        char* themedXml;
+        SVGTuint substitutions;
+        SVGTErrorCode err = themeApply(xml, args->theme, &themedXml, &substitutions);
+
+        if (err == SVGT_NO_ERROR) {
+            LOG_INFO_EXT("- %s themed (%u substitutions)\n", fileName, substitutions);
+            memFree(xml);
+            xml = themedXml;
+        }
+        else {
+            // go ahead with the original content
+            LOG_WARNING_EXT("- failed to apply the theme to %s (error code = %d)\n", fileName, err);
+        }
+    }
+
+    profileEnd(PROFILE_PHASE_LOAD, t);
+    return xml;
 }
 
 static void boxFit(SVGTuint* srcWidth,
@@ -91,8 +168,12 @@ static void boxFit(SVGTuint* srcWidth,
     *srcHeight = (SVGTuint)roundInteger(finalHeight);
 }
 
-static SimpleRect surfaceDimensionsCalc(const SVGTHandle doc,
-                                        const CommandArguments* args) {
+// calculate drawing surface dimensions, starting from the document intrinsic dimensions and viewport
+// (a NULL viewport means that it is not available)
+static SimpleRect dimensionsCalc(const SVGTfloat docWidthf,
+                                 const SVGTfloat docHeightf,
+                                 const SVGTfloat* docViewport,
+                                 const CommandArguments* args) {
 
     SimpleRect result = { 0U, 0U };
 
@@ -100,17 +181,14 @@ static SimpleRect surfaceDimensionsCalc(const SVGTHandle doc,
     if ((args->width < 0) || (args->height < 0)) {
 
         // round document dimensions
-        const SVGTint docWidth = roundInteger(svgtDocWidth(doc));
-        const SVGTint docHeight = roundInteger(svgtDocHeight(doc));
+        const SVGTint docWidth = roundInteger(docWidthf);
+        const SVGTint docHeight = roundInteger(docHeightf);
 
         // if the SVG document (i.e. the outermost <svg> element) does not specify 'width' and 'height'
         // attributes, we start with the 'viewBox' attribute (present in the outermost <svg> element)
         if ((docWidth < 1) || (docHeight < 1)) {
 
-            SVGTfloat docViewport[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-
-            // get document viewport (as it appears in the 'viewBox' attribute)
-            if (svgtDocViewportGet(doc, docViewport) == SVGT_NO_ERROR) {
+            if (docViewport != NULL) {
                 // round viewport dimensions
                 const SVGTint width = roundInteger(docViewport[2]);
                 const SVGTint height = roundInteger(docViewport[3]);
@@ -154,6 +232,111 @@ static SimpleRect surfaceDimensionsCalc(const SVGTHandle doc,
     return result;
 }
 
+// calculate drawing surface dimensions, according to the (parsed) document
+static SimpleRect surfaceDimensionsCalc(const SVGTHandle doc,
+                                        const CommandArguments* args) {
+
+    SVGTfloat docViewport[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    // get document viewport (as it appears in the 'viewBox' attribute)
+    const SVGTboolean hasViewport = (svgtDocViewportGet(doc, docViewport) == SVGT_NO_ERROR) ? SVGT_TRUE : SVGT_FALSE;
+
+    return dimensionsCalc(svgtDocWidth(doc), svgtDocHeight(doc), hasViewport ? docViewport : NULL, args);
+}
+
+// calculate drawing surface dimensions before parsing the document, probing its outermost <svg> element only;
+// SVGT_FALSE is returned if the probe is not exact (i.e. it could not match what AmanithSVG computes after parsing),
+// in which case dimensions must be calculated on the parsed document
+static SVGTboolean surfaceDimensionsProbe(const char* xmlBuffer,
+                                          const CommandArguments* args,
+                                          SimpleRect* dimensions) {
+
+    SvgDocInfo info;
+    SVGTboolean ok = SVGT_FALSE;
+
+    if ((svgScanProbe(xmlBuffer, strlen(xmlBuffer), args->dpi, args->screenWidth, args->screenHeight, &info) == SVGT_NO_ERROR) && info.exact) {
+        *dimensions = dimensionsCalc(info.width, info.height, info.viewport, args);
+        ok = SVGT_TRUE;
+    }
+
+    return ok;
+}
+
+static SimpleRect elementDimensionsCalc(const DocElements* elems,
+                                        const SVGTuint elemIdx,
+                                        const CommandArguments* args) {
+
+    SimpleRect result = { 0U, 0U };
+    const SVGTPackedRect* r = &elems->elements.data[elemIdx].rect;
+
+    // a negative number will cause the value to be taken directly from the element bounding box
+    if ((args->width < 0) || (args->height < 0)) {
+        if ((r->width > 0) && (r->height > 0)) {
+            // start with element dimensions, applying the scale argument
+            result.width = (SVGTuint)roundInteger((SVGTfloat)r->width * args->scale);
+            result.height = (SVGTuint)roundInteger((SVGTfloat)r->height * args->scale);
+        }
+    }
+    else {
+        // start with provided arguments (the element will be fitted and centered)
+        result.width = (SVGTuint)args->width;
+        result.height = (SVGTuint)args->height;
+    }
+
+    if ((result.width > 0U) && (result.height > 0U)) {
+
+        const SVGTuint maxAllowedDimension = svgtSurfaceMaxDimension();
+
+        if ((result.width > maxAllowedDimension) || (result.height > maxAllowedDimension)) {
+            // take care of the maximum allowed dimension for drawing surfaces
+            boxFit(&result.width, &result.height, maxAllowedDimension, maxAllowedDimension);
+        }
+    }
+
+    return result;
+}
+
+// encode the given pixels (32bit ARGB, bottom-up rows, as drawing surfaces store them) and write them to a PNG file
+static SVGTboolean pngPixelsWrite(const SVGTubyte* pixels,
+                                  const SVGTuint width,
+                                  const SVGTuint height,
+                                  const char* outFileName,
+                                  const CommandArguments* args) {
+
+    SVGTboolean ok;
+    size_t pngDataSize;
+    uint64_t t = profileBegin(PROFILE_PHASE_ENCODE);
+    // encode pixels to PNG
+    void* pngData = pngEncode(&pngDataSize, pixels, width, height, args->compressionLevel, args->pixelFormat, "", "");
+
+    profileEnd(PROFILE_PHASE_ENCODE, t);
+    if ((ok = (pngData != NULL))) {
+        FILE* pngFile;
+        t = profileBegin(PROFILE_PHASE_WRITE);
+        // open the output file
+        pngFile = fopen(outFileName, "wb");
+        if ((ok = (pngFile != NULL))) {
+            // write data
+            if (fwrite(pngData, 1, pngDataSize, pngFile) < pngDataSize) {
+                LOG_ERROR_EXT("failed to write output file (i.e. file not fully written) %s", outFileName);
+                ok = SVGT_FALSE;
+            }
+            // close file
+            (void)fclose(pngFile);
+        }
+        else {
+            LOG_ERROR_EXT("failed to open output file %s", outFileName);
+        }
+        profileEnd(PROFILE_PHASE_WRITE, t);
+        // free allocated memory
+        memFree(pngData);
+    }
+    else {
+        LOG_ERROR_EXT("failed to encode PNG data for %s", outFileName);
+    }
+
+    return ok;
+}
+
 static SVGTboolean pngWrite(SVGTHandle svgSurface,
                             const char* outFileName,
                             const CommandArguments* args) {
@@ -169,7 +352,7 @@ static SVGTboolean pngWrite(SVGTHandle svgSurface,
 
         const SVGTuint n = width * height;
         // each pixel is a 4-bytes RGBA
-        actualPixels = calloc(n, sizeof(SVGTuint));
+        actualPixels = memCalloc(n, sizeof(SVGTuint));
         if ((ok = (actualPixels != NULL))) {
             // copy surface pixels into temporary buffer, applying a dilate filter
             (void)svgtSurfaceCopy(svgSurface, actualPixels, SVGT_FALSE, SVGT_TRUE);
@@ -180,35 +363,11 @@ static SVGTboolean pngWrite(SVGTHandle svgSurface,
     }
 
     if (ok) {
-        size_t pngDataSize;
         // encode the drawing surface to PNG
-        void* pngData = pngEncode(&pngDataSize, actualPixels, width, height, args->compressionLevel, args->pixelFormat, "", "");
-
-        if ((ok = (pngData != NULL))) {
-            // open the output file
-            FILE* pngFile = fopen(outFileName, "wb");
-            if ((ok = (pngFile != NULL))) {
-                // write data
-                if (fwrite(pngData, 1, pngDataSize, pngFile) < pngDataSize) {
-                    LOG_ERROR_EXT("failed to write output file (i.e. file not fully written) %s", outFileName);
-                    ok = SVGT_FALSE;
-                }
-                // close file
-                (void)fclose(pngFile);
-            }
-            else {
-                LOG_ERROR_EXT("failed to open output file %s", outFileName);
-            }
-            // free allocated memory
-            free(pngData);
-        }
-        else {
-            LOG_ERROR_EXT("failed to encode PNG data for %s", outFileName);
-        }
-
+        ok = pngPixelsWrite(actualPixels, width, height, outFileName, args);
         // release temporary buffer
         if (args->filter == FILTER_DILATE) {
-            free(actualPixels);
+            memFree(actualPixels);
         }
     }
 
@@ -243,6 +402,348 @@ static char* logErrorDesc(const char* logBuffer) {
     return s;
 }
 
+// hide the first-level elements listed by the 'hide' argument, reporting the surface region that must be redrawn
+static void hiddenElementsApply(DocElements* elems,
+                                SVGTHandle svgSurface,
+                                const char* baseName,
+                                const CommandArguments* args) {
+
+    const char* ids = args->hiddenIds;
+    size_t len = strlen(ids);
+    SVGTint dirtyRect[4];
+
+    while (*ids != '\0') {
+
+        const char* idStart = skipSpaces(ids, &len);
+        const char* idEnd = skipUntilChar(idStart, &len, ',');
+        const size_t idLen = (size_t)(idEnd - idStart);
+        char id[256];
+
+        if ((idLen > 0U) && (idLen < sizeof(id))) {
+
+            SVGTint elemIdx;
+
+            (void)memcpy(id, idStart, idLen);
+            id[idLen] = '\0';
+            if ((elemIdx = docElementFind(elems, id)) >= 0) {
+                (void)docElementVisibilitySet(elems, (SVGTuint)elemIdx, SVGT_FALSE);
+            }
+            else {
+                LOG_WARNING_EXT("- %s does not contain a first-level element with id '%.128s'\n", baseName, id);
+            }
+        }
+
+        // skip comma
+        ids = (*idEnd == ',') ? (idEnd + 1) : idEnd;
+        len -= (*idEnd == ',') ? 1U : 0U;
+    }
+
+    if (docElementsDirtyRect(elems, svgSurface, dirtyRect) == SVGT_NO_ERROR) {
+        LOG_INFO_EXT("- %s hidden elements cover the region (%d, %d, %d, %d)\n", baseName, dirtyRect[0], dirtyRect[1], dirtyRect[2], dirtyRect[3]);
+    }
+}
+
+// report the first-level elements found under the hit-test point
+static void hitTestReport(DocElements* elems,
+                          SVGTHandle svgSurface,
+                          const char* baseName,
+                          const CommandArguments* args) {
+
+    DocHitResult results[16];
+    SVGTuint resultsCount = 0U;
+    const DocHitTestMode mode = args->hitTestExact ? DOC_HIT_TEST_EXACT : DOC_HIT_TEST_BBOX;
+    SVGTErrorCode err = docHitTest(elems, svgSurface, args->hitTestPoint[0], args->hitTestPoint[1], mode, results, 16U, &resultsCount);
+
+    if (err == SVGT_NO_ERROR) {
+        LOG_INFO_EXT("- %s hit-test at (%g, %g): %u element(s) found\n", baseName, args->hitTestPoint[0], args->hitTestPoint[1], resultsCount);
+        for (SVGTuint i = 0U; i < resultsCount; ++i) {
+            LOG_INFO_EXT("    #%u %s\n", results[i].elemIdx, (results[i].id != NULL) ? results[i].id : "<no id>");
+        }
+    }
+    else {
+        LOG_ERROR_EXT("\nhit-test failed on %s (AmanithSVG error code = %d)\n", baseName, err);
+    }
+}
+
+// report the complexity statistics of an SVG text
+static void docStatsReport(const char* fileName,
+                           const SvgScanStats* stats,
+                           const CommandArguments* args) {
+
+    LOG_INFO_EXT("- %s statistics: %u bytes, %u elements, %u attributes, max depth %u\n", fileName,
+                 (SVGTuint)stats->bytes, stats->elementsCount, stats->attributesCount, stats->maxDepth);
+    LOG_INFO_EXT("    groups %u, shapes %u, paths %u (%u segments), text runs %u, images %u, uses %u (%u instantiated elements)\n",
+                 stats->groupsCount, stats->shapesCount, stats->pathsCount, stats->pathSegmentsCount, stats->textRunsCount, stats->imagesCount,
+                 stats->usesCount, stats->useInstancesCount);
+    LOG_INFO_EXT("    gradients %u, patterns %u, masks %u, clip paths %u, filters %u (%u primitives), styles %u\n",
+                 stats->gradientsCount, stats->patternsCount, stats->masksCount, stats->clipPathsCount, stats->filtersCount, stats->filterPrimitivesCount, stats->stylesCount);
+}
+
+// tell if at least one complexity limit has been specified
+static SVGTboolean docLimitsEnabled(const CommandArguments* args) {
+
+    const SvgScanLimits* limits = &args->parseLimits;
+
+    return ((limits->maxElements > 0U) || (limits->maxUseInstances > 0U) || (limits->maxPathSegments > 0U) ||
+            (limits->maxDepth > 0U) || (limits->maxFilterPixels > 0U)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// check the complexity statistics of an SVG text against the limits; the filter pixels limit is checked only if
+// the drawing surface dimensions are given
+static SVGTErrorCode docLimitsCheck(const char* fileName,
+                                    const SvgScanStats* stats,
+                                    const SVGTuint surfaceWidth,
+                                    const SVGTuint surfaceHeight,
+                                    const CommandArguments* args) {
+
+    uint64_t value;
+    SVGTuint maxValue;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    const SvgScanLimit limit = svgScanLimitsCheck(stats, &args->parseLimits, surfaceWidth, surfaceHeight, &value, &maxValue);
+
+    if (limit != SVG_SCAN_LIMIT_NONE) {
+        LOG_ERROR_EXT("\n%s rejected, too high complexity: %s %.0f, the limit is %u (error code = %d)\n", fileName, svgScanLimitName(limit), (double)value, maxValue, SVG_SCAN_LIMIT_ERROR);
+        err = SVG_SCAN_LIMIT_ERROR;
+    }
+
+    return err;
+}
+
+// scan an SVG text, if complexity statistics or limits have been requested; SVG_SCAN_LIMIT_ERROR is returned if
+// the document exceeds the limits that do not depend on the drawing surface
+static SVGTErrorCode docScan(const char* fileName,
+                             const char* xmlBuffer,
+                             SvgScanStats* stats,
+                             const CommandArguments* args) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    if (args->docStats || docLimitsEnabled(args)) {
+
+        if ((err = svgScan(xmlBuffer, stats)) == SVGT_PARSER_ERROR) {
+            LOG_WARNING_EXT("- %s seems to be truncated, statistics could be incomplete\n", fileName);
+        }
+        else
+        if (err == SVGT_OUT_OF_MEMORY_ERROR) {
+            LOG_WARNING_EXT("- %s <use> references could not be expanded (out of memory)\n", fileName);
+        }
+
+        if (args->docStats) {
+            docStatsReport(fileName, stats, args);
+        }
+
+        if (!docLimitsEnabled(args)) {
+            err = SVGT_NO_ERROR;
+        }
+        else
+        if (err == SVGT_OUT_OF_MEMORY_ERROR) {
+            // the document cannot be trusted
+            LOG_ERROR_EXT("\n%s rejected, its complexity could not be checked (error code = %d)\n", fileName, SVG_SCAN_LIMIT_ERROR);
+            err = SVG_SCAN_LIMIT_ERROR;
+        }
+        else {
+            err = docLimitsCheck(fileName, stats, 0U, 0U, args);
+        }
+    }
+
+    return err;
+}
+
+// map a value in the [0; 1] range to a black, red, yellow, white color ramp (32bit ARGB)
+static SVGTuint heatColor(const SVGTfloat t) {
+
+    const SVGTuint r = (SVGTuint)(255.0f * MIN(MAX(3.0f * t, 0.0f), 1.0f));
+    const SVGTuint g = (SVGTuint)(255.0f * MIN(MAX((3.0f * t) - 1.0f, 0.0f), 1.0f));
+    const SVGTuint b = (SVGTuint)(255.0f * MIN(MAX((3.0f * t) - 2.0f, 0.0f), 1.0f));
+
+    return 0xFF000000U | (r << 16) | (g << 8) | b;
+}
+
+// write the cost heatmap: each element spreads its drawing time evenly over its clipped bounding box, and
+// the time accumulated by each pixel (normalized against the most expensive pixel) is mapped to a color ramp
+static SVGTboolean costHeatmapWrite(const DocElementCost* costs,
+                                    const SVGTuint costsCount,
+                                    const SVGTuint width,
+                                    const SVGTuint height,
+                                    const char* outFileName,
+                                    const CommandArguments* args) {
+
+    SVGTboolean ok;
+    const size_t n = (size_t)width * (size_t)height;
+    SVGTfloat* density = memCalloc(n, sizeof(SVGTfloat));
+    SVGTuint* pixels = memMalloc(n * sizeof(SVGTuint));
+
+    if ((ok = ((density != NULL) && (pixels != NULL)))) {
+
+        SVGTuint i;
+        size_t j;
+        SVGTfloat maxDensity = 0.0f;
+
+        // accumulate drawing time per pixel, in nanoseconds
+        for (i = 0U; i < costsCount; ++i) {
+            if (costs[i].bboxPixels > 0U) {
+                SVGTint x, y;
+                const SVGTfloat d = (SVGTfloat)costs[i].ns / (SVGTfloat)costs[i].bboxPixels;
+                for (y = costs[i].bbox[1]; y < costs[i].bbox[3]; ++y) {
+                    // surface rows are stored bottom-up
+                    SVGTfloat* row = &density[(size_t)(height - 1U - (SVGTuint)y) * width];
+                    for (x = costs[i].bbox[0]; x < costs[i].bbox[2]; ++x) {
+                        row[x] += d;
+                    }
+                }
+            }
+        }
+        for (j = 0U; j < n; ++j) {
+            maxDensity = MAX(maxDensity, density[j]);
+        }
+        for (j = 0U; j < n; ++j) {
+            pixels[j] = heatColor((maxDensity > 0.0f) ? (density[j] / maxDensity) : 0.0f);
+        }
+        ok = pngPixelsWrite((const SVGTubyte*)pixels, width, height, outFileName, args);
+    }
+    else {
+        LOG_ERROR_EXT("failed to allocate the cost heatmap for %s", outFileName);
+    }
+
+    memFree(pixels);
+    memFree(density);
+    return ok;
+}
+
+// draw the document element by element, reporting the most expensive ones and writing the cost
+// heatmap next to the output file (<output name>-heatmap.png)
+static SVGTErrorCode costReportDraw(DocElements* elems,
+                                    SVGTHandle svgSurface,
+                                    const char* baseName,
+                                    const char* outFileName,
+                                    const CommandArguments* args) {
+
+    SVGTErrorCode err;
+    DocElementCost* costs = memMalloc((elems->elements.size + 1U) * sizeof(DocElementCost));
+
+    if (costs != NULL) {
+
+        SVGTuint costsCount;
+
+        if ((err = docElementsCostReport(elems, svgSurface, SVGT_RENDERING_QUALITY_BETTER, costs, &costsCount)) == SVGT_NO_ERROR) {
+
+            SVGTuint i;
+            FileName heatmapFileName;
+            uint64_t total = 0U;
+            const SVGTuint n = MIN(costsCount, COST_REPORT_MAX_ELEMENTS);
+
+            for (i = 0U; i < costsCount; ++i) {
+                total += costs[i].ns;
+            }
+            LOG_INFO_EXT("- %s cost report (%u elements drawn in %.3f ms, the %u most expensive follow)\n", baseName, costsCount, (double)total / 1000000.0, n);
+            for (i = 0U; i < n; ++i) {
+                LOG_INFO_EXT("    #%-4u %-32s %9.3f ms %5.1f%% %9u bbox pixels\n", costs[i].elemIdx, (costs[i].id != NULL) ? costs[i].id : "<no id>",
+                             (double)costs[i].ns / 1000000.0, (total > 0U) ? ((100.0 * (double)costs[i].ns) / (double)total) : 0.0, costs[i].bboxPixels);
+            }
+            // write the heatmap (<output name without .png extension>-heatmap.png)
+            if (strlen(outFileName) < (sizeof(heatmapFileName.name) - 12U)) {
+                const size_t len = strlen(outFileName);
+                (void)strcpy(heatmapFileName.name, outFileName);
+                if ((len >= 4U) && (strcmp(&heatmapFileName.name[len - 4U], ".png") == 0)) {
+                    heatmapFileName.name[len - 4U] = '\0';
+                }
+                (void)strcat(heatmapFileName.name, "-heatmap.png");
+                if (costHeatmapWrite(costs, costsCount, svgtSurfaceWidth(svgSurface), svgtSurfaceHeight(svgSurface), heatmapFileName.name, args)) {
+                    LOG_INFO_EXT("- %s cost heatmap written\n", baseName);
+                }
+            }
+        }
+        else {
+            LOG_ERROR_EXT("\ncost report failed on %s (AmanithSVG error code = %d)\n", baseName, err);
+        }
+
+        memFree(costs);
+    }
+    else {
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    return err;
+}
+
+// draw the document in steps, each one limited by the given time budget
+static SVGTErrorCode incrementalDraw(DocElements* elems,
+                                     SVGTHandle svgSurface,
+                                     const char* baseName,
+                                     const CommandArguments* args) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    DocDrawState state;
+    SVGTuint steps = 0U;
+
+    docDrawStateInit(&state);
+    while ((!state.done) && (err == SVGT_NO_ERROR)) {
+        err = docElementsDrawStep(elems, svgSurface, SVGT_RENDERING_QUALITY_BETTER, args->drawBudget, &state);
+        steps++;
+    }
+
+    if (err == SVGT_NO_ERROR) {
+        LOG_INFO_EXT("- %s drawn in %u steps (budget of %u microseconds each)\n", baseName, steps, args->drawBudget);
+    }
+    return err;
+}
+
+// get the amount of memory used by the pixels of a drawing surface, in bytes
+size_t surfaceMemoryUsage(const SVGTHandle surface) {
+
+    // 32bit per pixel
+    return (size_t)svgtSurfaceWidth(surface) * (size_t)svgtSurfaceHeight(surface) * 4U;
+}
+
+// create a drawing surface, checking it against the memory limit first
+SVGTErrorCode surfaceCreate(const SVGTuint width,
+                            const SVGTuint height,
+                            SVGTHandle* surface) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    // 32bit per pixel
+    if (!memLimitFits((size_t)width * (size_t)height * 4U)) {
+        *surface = SVGT_INVALID_HANDLE;
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+    else
+    if ((*surface = svgtSurfaceCreate(width, height)) == SVGT_INVALID_HANDLE) {
+        err = svgtGetLastError();
+    }
+    else {
+        memExternalAcquired(surfaceMemoryUsage(*surface));
+    }
+
+    return err;
+}
+
+// destroy a drawing surface created by surfaceCreate
+void surfaceDestroy(const SVGTHandle surface) {
+
+    memExternalReleased(surfaceMemoryUsage(surface));
+    (void)svgtSurfaceDestroy(surface);
+}
+
+// report memory usage of a rendered file
+static void memoryStatsReport(const char* fileName,
+                              const SVGTHandle surface,
+                              const DocElements* elems,
+                              const char* xmlBuffer,
+                              const CommandArguments* args) {
+
+    MemStats stats;
+
+    memStatsGet(&stats);
+    LOG_INFO_EXT("- %s memory: surface %u bytes, elements index %u bytes, XML %u bytes\n", fileName,
+                 (SVGTuint)surfaceMemoryUsage(surface),
+                 (elems != NULL) ? (SVGTuint)docElementsMemoryUsage(elems) : 0U,
+                 (SVGTuint)(strlen(xmlBuffer) + 1U));
+    // drawing surfaces allocated by AmanithSVG are included within heap statistics
+    LOG_INFO_EXT("    heap: current %u bytes, peak %u bytes, %u live blocks, %u allocations (%u refused)\n",
+                 (SVGTuint)stats.currentBytes, (SVGTuint)stats.peakBytes, (SVGTuint)stats.liveBlocks, (SVGTuint)stats.allocationsCount, (SVGTuint)stats.refusedCount);
+}
+
 static SVGTboolean svgRender(const char* inFileName,
                              const char* outFileName,
                              const CommandArguments* args) {
@@ -255,34 +756,144 @@ static SVGTboolean svgRender(const char* inFileName,
     extractFileName(baseFileName.name, inFileName, SVGT_TRUE);
 
     // allocate buffer and load SVG file
-    if ((xmlBuffer = loadXml(inFileName)) != NULL) {
+    if ((xmlBuffer = loadXml(inFileName, args)) != NULL) {
+
+        uint64_t t;
+        SVGTHandle svgDoc;
+        SvgScanStats stats;
+        SimpleRect r = { 0U, 0U };
+        // gather statistics and check complexity limits, before parsing
+        SVGTboolean rejected = (docScan(baseFileName.name, xmlBuffer, &stats, args) == SVG_SCAN_LIMIT_ERROR) ? SVGT_TRUE : SVGT_FALSE;
+        // plan the drawing surface probing the outermost <svg> element only, so that unusable documents are not parsed at all
+        const SVGTboolean planned = ((!rejected) && (args->elementId == NULL)) ? surfaceDimensionsProbe(xmlBuffer, args, &r) : SVGT_FALSE;
+
+        if (planned) {
+            if ((r.width == 0U) || (r.height == 0U)) {
+                LOG_INFO_EXT("- %s skipped, <svg> root element does not contain valid width or height attributes\n", baseFileName.name);
+                rejected = SVGT_TRUE;
+            }
+            else
+            if (!memLimitFits((size_t)r.width * (size_t)r.height * 4U)) {
+                LOG_ERROR_EXT("\nthe %ux%u drawing surface for %s would exceed the memory limit\n", r.width, r.height, baseFileName.name);
+                rejected = SVGT_TRUE;
+            }
+            else
+            if (docLimitsEnabled(args)) {
+                // filter costs depend on the drawing surface dimensions
+                rejected = (docLimitsCheck(baseFileName.name, &stats, r.width, r.height, args) == SVG_SCAN_LIMIT_ERROR) ? SVGT_TRUE : SVGT_FALSE;
+            }
+        }
+
+        t = profileBegin(PROFILE_PHASE_PARSE);
+        // create (and parse) the SVG document, unless it has been rejected
+        svgDoc = (!rejected) ? svgtDocCreate(xmlBuffer) : SVGT_INVALID_HANDLE;
 
-        // create (and parse) the SVG document
-        SVGTHandle svgDoc = svgtDocCreate(xmlBuffer);
+        profileEndExt(PROFILE_PHASE_PARSE, t, svgDoc, -1);
         if (svgDoc != SVGT_INVALID_HANDLE) {
 
-            // calculate drawing surface dimension
-            const SimpleRect r = surfaceDimensionsCalc(svgDoc, args);
+            DocElements elems;
+            SVGTint elemIdx = -1;
+            SVGTboolean elemsBuilt = SVGT_FALSE;
+
+            if (elementsIndexNeeded(args)) {
+                const uint64_t tIndex = profileBegin(PROFILE_PHASE_INDEX);
+                // build the index of first-level elements
+                SVGTErrorCode err = docElementsBuild(&elems, svgDoc);
+
+                profileEndExt(PROFILE_PHASE_INDEX, tIndex, svgDoc, (err == SVGT_NO_ERROR) ? (SVGTint)elems.elements.size : -1);
+                if (err == SVGT_NO_ERROR) {
+                    elemsBuilt = SVGT_TRUE;
+                }
+                else {
+                    LOG_ERROR_EXT("\nfailed to collect the elements of %s (AmanithSVG error code = %d)\n", baseFileName.name, err);
+                }
+            }
+
+            if (args->elementId != NULL) {
+                // select the requested element
+                if (elemsBuilt) {
+                    if ((elemIdx = docElementFind(&elems, args->elementId)) >= 0) {
+                        SVGTfloat bbox[4];
+                        // report the element bounding box, in document coordinates
+                        if (docElementBBox(&elems, (SVGTuint)elemIdx, DOC_ELEMENT_SPACE_DOCUMENT, SVGT_INVALID_HANDLE, bbox) == SVGT_NO_ERROR) {
+                            LOG_INFO_EXT("- %s#%s bounding box is (%g, %g, %g, %g)\n", baseFileName.name, args->elementId, bbox[0], bbox[1], bbox[2], bbox[3]);
+                        }
+                        // calculate drawing surface dimension, according to the element bounding box
+                        r = elementDimensionsCalc(&elems, (SVGTuint)elemIdx, args);
+                    }
+                    else {
+                        LOG_INFO_EXT("- %s skipped, it does not contain a first-level element with id '%s'\n", baseFileName.name, args->elementId);
+                    }
+                }
+            }
+            else
+            if (!planned) {
+                // calculate drawing surface dimension
+                r = surfaceDimensionsCalc(svgDoc, args);
+            }
+
             if ((r.width > 0U) && (r.height > 0U)) {
 
+                SVGTHandle svgSurface;
+                // filter costs depend on the drawing surface dimensions
+                SVGTErrorCode err = (docLimitsEnabled(args) && (!planned)) ? docLimitsCheck(baseFileName.name, &stats, r.width, r.height, args) : SVGT_NO_ERROR;
+
                 // create the drawing surface
-                SVGTHandle svgSurface = svgtSurfaceCreate(r.width, r.height);
-                if (svgSurface != SVGT_INVALID_HANDLE) {
+                if (err == SVGT_NO_ERROR) {
+                    err = surfaceCreate(r.width, r.height, &svgSurface);
+                }
 
-                    SVGTErrorCode err;
+                if (err == SVGT_NO_ERROR) {
 
                     // clear the drawing surface
                     if ((err = svgtSurfaceClear(svgSurface, args->clearColor[0], args->clearColor[1], args->clearColor[2], args->clearColor[3])) == SVGT_NO_ERROR) {
+
+                        uint64_t tDraw;
+
                         // clear / rewind log buffer
                         if (args->logBuffer != NULL) {
                             (void)svgtLogBufferSet(args->logBuffer, args->logBufferCapacity, SVGT_LOG_LEVEL_ERROR);
                         }
-                        // draw the document
-                        if ((err = svgtDocDraw(svgDoc, svgSurface, SVGT_RENDERING_QUALITY_BETTER)) == SVGT_NO_ERROR) {
+                        tDraw = profileBegin(PROFILE_PHASE_DRAW);
+                        // draw the document (or just the selected element)
+                        if (elemIdx >= 0) {
+                            err = docElementDraw(&elems, (SVGTuint)elemIdx, svgSurface, SVGT_RENDERING_QUALITY_BETTER);
+                        }
+                        else
+                        if (elemsBuilt && ((args->hiddenIds != NULL) || args->costReport || (args->deadline > 0U) || (args->drawBudget > 0U))) {
+                            // draw element by element, skipping the hidden ones
+                            if (args->hiddenIds != NULL) {
+                                hiddenElementsApply(&elems, svgSurface, baseFileName.name, args);
+                            }
+                            if (args->costReport) {
+                                err = costReportDraw(&elems, svgSurface, baseFileName.name, outFileName, args);
+                            }
+                            else
+                            if (args->drawBudget > 0U) {
+                                err = incrementalDraw(&elems, svgSurface, baseFileName.name, args);
+                            }
+                            else
+                            if (args->deadline > 0U) {
+                                const DocDrawLimits limits = { timerNowNs() + ((uint64_t)args->deadline * 1000000U) };
+                                err = docElementsDrawLimited(&elems, svgSurface, SVGT_RENDERING_QUALITY_BETTER, &limits);
+                            }
+                            else {
+                                err = docElementsRegionDraw(&elems, svgSurface, NULL, svgSurface, SVGT_RENDERING_QUALITY_BETTER);
+                            }
+                        }
+                        else {
+                            err = svgtDocDraw(svgDoc, svgSurface, SVGT_RENDERING_QUALITY_BETTER);
+                        }
+                        profileEndExt(PROFILE_PHASE_DRAW, tDraw, svgDoc, -1);
+                        if (err == SVGT_NO_ERROR) {
                             // write drawing surface content to PNG file
                             if ((ok = pngWrite(svgSurface, outFileName, args))) {
                                 LOG_INFO_EXT("- %s rendered successfully\n", baseFileName.name);
                             }
+                            // hit-testing refers to the whole document rendering
+                            if (elemsBuilt && args->hitTest && (elemIdx < 0)) {
+                                hitTestReport(&elems, svgSurface, baseFileName.name, args);
+                            }
                         }
                         else {
                             if (err == SVGT_INVALID_SVG_ERROR) {
@@ -299,6 +910,11 @@ static SVGTboolean svgRender(const char* inFileName,
                                 // including, the first element which has an error
                                 ok = pngWrite(svgSurface, outFileName, args);
                             }
+                            else
+                            if (err == DOC_DRAW_CANCELLED_ERROR) {
+                                LOG_ERROR_EXT("\ndrawing of %s exceeded the deadline of %u ms, the partially drawn surface is written\n", baseFileName.name, args->deadline);
+                                ok = pngWrite(svgSurface, outFileName, args);
+                            }
                             else {
                                 // other AmanithSVG errors (e.g. out of memory, parser errors due to malformed XML)
                                 // in this case we don't write the PNG file
@@ -312,29 +928,43 @@ static SVGTboolean svgRender(const char* inFileName,
                         ok = SVGT_FALSE;
                     }
 
+                    if (args->memoryStats) {
+                        memoryStatsReport(baseFileName.name, svgSurface, elemsBuilt ? &elems : NULL, xmlBuffer, args);
+                    }
+
                     // destroy the drawing surface
-                    (void)svgtSurfaceDestroy(svgSurface);
+                    surfaceDestroy(svgSurface);
                 }
                 else {
-                    LOG_ERROR_EXT("\nfailed to create the drawing surface for %s (AmanithSVG error code = %d)\n", baseFileName.name, svgtGetLastError());
+                    if (err != SVG_SCAN_LIMIT_ERROR) {
+                        LOG_ERROR_EXT("\nfailed to create the %ux%u drawing surface for %s (AmanithSVG error code = %d)\n", r.width, r.height, baseFileName.name, err);
+                    }
                     ok = SVGT_FALSE;
                 }
-
-                // destroy SVG document
-                (void)svgtDocDestroy(svgDoc);
             }
             else {
-                LOG_INFO_EXT("- %s skipped, <svg> root element does not contain valid width or height attributes\n", baseFileName.name);
+                if (args->elementId == NULL) {
+                    LOG_INFO_EXT("- %s skipped, <svg> root element does not contain valid width or height attributes\n", baseFileName.name);
+                }
                 ok = SVGT_FALSE;
             }
+
+            // release the elements index
+            if (elementsIndexNeeded(args)) {
+                docElementsDestroy(&elems);
+            }
+            // destroy SVG document
+            (void)svgtDocDestroy(svgDoc);
         }
         else {
-            LOG_ERROR_EXT("\nfailed to create SVG document for %s (AmanithSVG error code = %d)\n", baseFileName.name, svgtGetLastError());
+            if (!rejected) {
+                LOG_ERROR_EXT("\nfailed to create SVG document for %s (AmanithSVG error code = %d)\n", baseFileName.name, svgtGetLastError());
+            }
             ok = SVGT_FALSE;
         }
 
         // free xml buffer
-        free(xmlBuffer);
+        memFree(xmlBuffer);
     }
     else {
         LOG_ERROR_EXT("\nfailed to load file %s\n", baseFileName.name);
@@ -344,28 +974,37 @@ static SVGTboolean svgRender(const char* inFileName,
     return ok;
 }
 
-SVGTboolean svg2BitmapFile(const CommandArguments* args) {
+// collect the input SVG files: a single file, or the content of a directory
+SVGTboolean inputFilesCollect(const CommandArguments* args,
+                              FileSearchResult* searchResult) {
 
     SVGTboolean ok = SVGT_TRUE;
-    FileSearchResult searchResult = { 0 };
-
-    // initialize temporary array
-    DYNARRAY_INIT(searchResult.fileNames)
 
     // if 'inputDir' is a directory, perform a scan; else 'inputDir' is a regular file
     if (directoryExists(args->inputDir.name)) {
-        static const char svgFilter[] = "svg";
+        static const char svgFilter[] = "svg;svgz";
         // setup search settings (no recursive scan, add path to returned file names, no filter on extension)
         const FileSearchSettings searchSettings = { SVGT_FALSE, SVGT_TRUE, svgFilter };
         // scan the path
-        ok = scanPath(&searchResult, &searchSettings, args->inputDir.name);
+        ok = scanPath(searchResult, &searchSettings, args->inputDir.name);
     }
     else {
         // just a single regular file
-        DYNARRAY_PUSH_BACK(searchResult.fileNames, FileName, args->inputDir)
+        DYNARRAY_PUSH_BACK(searchResult->fileNames, FileName, args->inputDir)
     }
 
-    if (ok) {
+    return ok;
+}
+
+SVGTboolean svg2BitmapFile(const CommandArguments* args) {
+
+    SVGTboolean ok;
+    FileSearchResult searchResult = { 0 };
+
+    // initialize temporary array
+    DYNARRAY_INIT(searchResult.fileNames)
+
+    if ((ok = inputFilesCollect(args, &searchResult))) {
 
         // loop over the input SVG files
         for (size_t i = 0U; (i < searchResult.fileNames.size); ++i) {
@@ -408,20 +1047,32 @@ static SVGTboolean atlasDocumentsLoad(const CommandArguments* args) {
 
         AtlasInput* input = &args->atlasInputs.data[i];
         // allocate buffer and load SVG file
-        char* xmlBuffer = loadXml(input->fullFileName.name);
+        char* xmlBuffer = loadXml(input->fullFileName.name, args);
 
         // allocate buffer and load SVG file
         if (xmlBuffer != NULL) {
-            // create (and parse) the SVG document
-            if ((input->docHandle = svgtDocCreate(xmlBuffer)) != SVGT_INVALID_HANDLE) {
-                LOG_INFO_EXT("- %s loaded successfully\n", input->fullFileName.name);
+            SvgScanStats stats;
+            uint64_t t;
+
+            // gather statistics and check complexity limits, before parsing
+            if (docScan(input->fullFileName.name, xmlBuffer, &stats, args) == SVG_SCAN_LIMIT_ERROR) {
+                ok = SVGT_FALSE;
             }
             else {
-                LOG_ERROR_EXT("\nfailed to create SVG document for %s (AmanithSVG error code = %d)\n", input->fullFileName.name, svgtGetLastError());
-                ok = SVGT_FALSE;
+                t = profileBegin(PROFILE_PHASE_PARSE);
+                // create (and parse) the SVG document
+                input->docHandle = svgtDocCreate(xmlBuffer);
+                profileEndExt(PROFILE_PHASE_PARSE, t, input->docHandle, -1);
+                if (input->docHandle != SVGT_INVALID_HANDLE) {
+                    LOG_INFO_EXT("- %s loaded successfully\n", input->fullFileName.name);
+                }
+                else {
+                    LOG_ERROR_EXT("\nfailed to create SVG document for %s (AmanithSVG error code = %d)\n", input->fullFileName.name, svgtGetLastError());
+                    ok = SVGT_FALSE;
+                }
             }
             // free xml buffer
-            free(xmlBuffer);
+            memFree(xmlBuffer);
         }
         else {
             LOG_ERROR_EXT("\nfailed to load file %s\n", input->fullFileName.name);
@@ -452,9 +1103,12 @@ static SVGTboolean atlasDocumentAdd(const SVGTuint index,
     SVGTboolean ok = SVGT_TRUE;
     SVGTuint info[2] = { 0, 0 };
     AtlasInput* input = &args->atlasInputs.data[index];
+    const uint64_t t = profileBegin(PROFILE_PHASE_PACK);
     // add the loaded document to the collection process
     SVGTErrorCode err = svgtPackingAdd(input->docHandle, input->explodeGroups, input->scale, info);
 
+    // info[0] = number of collected elements
+    profileEndExt(PROFILE_PHASE_PACK, t, input->docHandle, (SVGTint)info[0]);
     if (err == SVGT_NO_ERROR) {
         // info[0] = number of collected elements
         // info[1] = the actual number of elements that could be packed (less than or equal to info[0])
@@ -611,16 +1265,20 @@ static SVGTboolean atlasPageRender(const SVGTuint index,
         // draw collected groups/rectangles
         if ((rects != NULL) && (pageInfo[2] > 0)) {
 
+            SVGTHandle svgSurface;
+
             // create the drawing surface
-            SVGTHandle svgSurface = svgtSurfaceCreate(pageInfo[0], pageInfo[1]);
-            if ((ok = (svgSurface != SVGT_INVALID_HANDLE))) {
+            err = surfaceCreate((SVGTuint)pageInfo[0], (SVGTuint)pageInfo[1], &svgSurface);
+            if ((ok = (err == SVGT_NO_ERROR))) {
 
                 // clear the drawing surface
                 err = svgtSurfaceClear(svgSurface, args->clearColor[0], args->clearColor[1], args->clearColor[2], args->clearColor[3]);
                 if ((ok = (err == SVGT_NO_ERROR))) {
 
+                    const uint64_t t = profileBegin(PROFILE_PHASE_DRAW);
                     // draw packed elements
                     err = svgtPackingRectsDraw(rects, pageInfo[2], svgSurface, SVGT_RENDERING_QUALITY_BETTER);
+                    profileEndExt(PROFILE_PHASE_DRAW, t, SVGT_INVALID_HANDLE, pageInfo[2]);
                     if ((ok = (err == SVGT_NO_ERROR))) {
 
                         // write atlas page PNG
@@ -645,10 +1303,10 @@ static SVGTboolean atlasPageRender(const SVGTuint index,
                 }
 
                 // destroy the drawing surface
-                (void)svgtSurfaceDestroy(svgSurface);
+                surfaceDestroy(svgSurface);
             }
             else {
-                LOG_ERROR_EXT("\nfailed to create the drawing surface for atlas page %d (AmanithSVG error code = %d)\n", index, svgtGetLastError());
+                LOG_ERROR_EXT("\nfailed to create the drawing surface for atlas page %d (AmanithSVG error code = %d)\n", index, err);
             }
         }
     }
@@ -680,8 +1338,10 @@ SVGTboolean svg2BitmapAtlas(CommandArguments* args,
             }
 
             if (ok) {
+                const uint64_t t = profileBegin(PROFILE_PHASE_PACK);
                 // close the current packing task and perform the real packing algorithm
                 err = svgtPackingEnd(SVGT_TRUE);
+                profileEnd(PROFILE_PHASE_PACK, t);
                 if ((ok = (err == SVGT_NO_ERROR))) {
 
                     AtlasExporter exporter;
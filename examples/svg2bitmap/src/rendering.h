@@ -47,11 +47,32 @@
 */
 
 #include "config.h"
+#include "file_utils.h"
+
+/************************************************************
+                      Drawing surfaces
+************************************************************/
+
+// get the amount of memory used by the pixels of a drawing surface, in bytes
+size_t surfaceMemoryUsage(const SVGTHandle surface);
+
+// create a drawing surface, checking it against the memory limit first; its pixels are accounted
+// within memory statistics, so that the surface must be released through surfaceDestroy
+SVGTErrorCode surfaceCreate(const SVGTuint width,
+                            const SVGTuint height,
+                            SVGTHandle* surface);
+
+// destroy a drawing surface created by surfaceCreate
+void surfaceDestroy(const SVGTHandle surface);
 
 /************************************************************
                        SVG rendering
 ************************************************************/
 
+// collect the input SVG files: a single file, or the content of a directory
+SVGTboolean inputFilesCollect(const CommandArguments* args,
+                              FileSearchResult* searchResult);
+
 SVGTboolean svg2BitmapFile(const CommandArguments* args);
 
 SVGTboolean svg2BitmapAtlas(CommandArguments* args,
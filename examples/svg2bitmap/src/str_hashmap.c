@@ -176,7 +176,7 @@ SVGTErrorCode strHashMapInit(StringHashMap* hashMap,
     }
     else {
         // allocate initial space
-        if ((hashMap->data = (StringHashMapElement*)calloc(initialSize, sizeof(StringHashMapElement))) == NULL) {
+        if ((hashMap->data = (StringHashMapElement*)memCalloc(initialSize, sizeof(StringHashMapElement))) == NULL) {
             err = SVGT_OUT_OF_MEMORY_ERROR;
         }
         else {
@@ -192,7 +192,7 @@ void strHashMapDestroy(StringHashMap* hashMap) {
 
     // free allocated memory
     if (hashMap->data != NULL) {
-        free(hashMap->data);
+        memFree(hashMap->data);
         hashMap->data = NULL;
     }
     hashMap->tableSize = 0U;
@@ -259,7 +259,7 @@ static SVGTErrorCode rehash(StringHashMap* hashMap) {
 
     SVGTuint i, oldSize;
     StringHashMapElement* curr;
-    StringHashMapElement* temp = (StringHashMapElement*)calloc(2U * hashMap->tableSize, sizeof(StringHashMapElement));
+    StringHashMapElement* temp = (StringHashMapElement*)memCalloc(2U * hashMap->tableSize, sizeof(StringHashMapElement));
 
     if (temp == NULL) {
         return SVGT_OUT_OF_MEMORY_ERROR;
@@ -289,7 +289,7 @@ static SVGTErrorCode rehash(StringHashMap* hashMap) {
         }
     }
 
-    free(curr);
+    memFree(curr);
     return SVGT_NO_ERROR;
 }
 
@@ -228,3 +228,34 @@ SVGTint axtoi(const char* str) {
 
     return (SVGTint)res;
 }
+
+// append the given chars to the buffer
+SVGTboolean strBufferAppend(StrBuffer* buffer,
+                            const char* str,
+                            const size_t len) {
+
+    SVGTboolean ok = SVGT_TRUE;
+
+    // take care of the trailing '\0' too
+    if ((buffer->size + len + 1U) > buffer->capacity) {
+
+        const size_t newCapacity = MAX(buffer->capacity * 2U, buffer->size + len + 1U);
+        char* newData = memRealloc(buffer->data, newCapacity);
+
+        if (newData != NULL) {
+            buffer->data = newData;
+            buffer->capacity = newCapacity;
+        }
+        else {
+            ok = SVGT_FALSE;
+        }
+    }
+
+    if (ok) {
+        (void)memcpy(&buffer->data[buffer->size], str, len);
+        buffer->size += len;
+        buffer->data[buffer->size] = '\0';
+    }
+
+    return ok;
+}
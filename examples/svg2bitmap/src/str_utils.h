@@ -85,4 +85,19 @@ const char* skipUntilChar(const char* str,
 // convert an hexadecimal string to integer
 SVGTint axtoi(const char* str);
 
+/************************************************************
+                    Growable text buffer
+************************************************************/
+// a null-terminated text buffer, grown on demand through memRealloc (the caller releases 'data' through memFree)
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} StrBuffer;
+
+// append the given chars to the buffer; SVGT_FALSE is returned if the buffer could not be grown (its content is left untouched)
+SVGTboolean strBufferAppend(StrBuffer* buffer,
+                            const char* str,
+                            const size_t len);
+
 #endif /* STR_UTILS_H */
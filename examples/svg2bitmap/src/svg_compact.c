@@ -0,0 +1,252 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file svg_compact.c
+    \brief Removal of SVG content that is not needed for drawing, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "svg_compact.h"
+#include "str_utils.h"
+#include "svg_scan.h"
+
+// tell if the given name (not null-terminated) belongs to an editor namespace
+static SVGTboolean editorName(const char* name,
+                              const size_t nameLen) {
+
+    return (((nameLen > 9U) && (strncmp(name, "inkscape:", 9U) == 0)) ||
+            ((nameLen > 9U) && (strncmp(name, "sodipodi:", 9U) == 0))) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// get the position just after the end of the element whose start tag begins at the given position
+static const char* elementEnd(const char* str,
+                              const char* name,
+                              const size_t nameLen) {
+
+    const char* p = svgScanTagEnd(str);
+    SVGTuint depth = 1U;
+
+    // self-closing tag
+    if ((p - str >= 2) && (p[-1] == '>') && (p[-2] == '/')) {
+        depth = 0U;
+    }
+
+    while ((*p != '\0') && (depth > 0U)) {
+        if ((p[0] == '<') && (strncmp(p + 1, name, nameLen) == 0) && (!svgScanNameChar(p[nameLen + 1U]))) {
+            // nested element with the same name
+            const char* end = svgScanTagEnd(p);
+            depth += ((end[-1] == '>') && (end[-2] == '/')) ? 0U : 1U;
+            p = end;
+        }
+        else
+        if ((p[0] == '<') && (p[1] == '/') && (strncmp(p + 2, name, nameLen) == 0) && (!svgScanNameChar(p[nameLen + 2U]))) {
+            depth--;
+            p = svgScanTagEnd(p);
+        }
+        else
+        if (strncmp(p, "<!--", 4U) == 0) {
+            p = svgScanSkipPast(p + 4, "-->");
+        }
+        else
+        if (strncmp(p, "<![CDATA[", 9U) == 0) {
+            p = svgScanSkipPast(p + 9, "]]>");
+        }
+        else {
+            p++;
+        }
+    }
+
+    return p;
+}
+
+// copy a start tag, optionally dropping editor specific attributes; it returns the new write position
+static char* tagCopy(char* w,
+                     const char** r,
+                     const SVGTuint flags) {
+
+    const char* p = *r;
+    const char* end = svgScanTagEnd(p);
+
+    while (p < end) {
+
+        if (((flags & SVG_COMPACT_EDITOR) != 0U) && isSpace(*p)) {
+
+            const char* name = p;
+            const char* nameEnd;
+
+            while ((name < end) && isSpace(*name)) {
+                name++;
+            }
+            nameEnd = name;
+            while ((nameEnd < end) && svgScanNameChar(*nameEnd)) {
+                nameEnd++;
+            }
+
+            if (editorName(name, (size_t)(nameEnd - name))) {
+                // skip '=' and the quoted value, together with the leading spaces
+                const char* v = nameEnd;
+                while ((v < end) && (isSpace(*v) || (*v == '='))) {
+                    v++;
+                }
+                if ((v < end) && ((*v == '"') || (*v == '\''))) {
+                    const char quote = *v++;
+                    while ((v < end) && (*v != quote)) {
+                        v++;
+                    }
+                    v += (v < end) ? 1 : 0;
+                }
+                p = v;
+            }
+            else {
+                *w++ = *p++;
+            }
+        }
+        else {
+            // quoted values are copied at once, so that they are never mistaken for attributes
+            if ((*p == '"') || (*p == '\'')) {
+                const char quote = *p;
+                *w++ = *p++;
+                while ((p < end) && (*p != quote)) {
+                    *w++ = *p++;
+                }
+            }
+            if (p < end) {
+                *w++ = *p++;
+            }
+        }
+    }
+
+    *r = end;
+    return w;
+}
+
+// remove the content selected by the given flags from the given null-terminated SVG text
+size_t svgCompact(char* xml,
+                  const SVGTuint flags) {
+
+    const char* r = xml;
+    char* w = xml;
+    // <text> elements nesting level
+    SVGTuint textDepth = 0U;
+
+    while (*r != '\0') {
+
+        if (strncmp(r, "<!--", 4U) == 0) {
+            const char* end = svgScanSkipPast(r + 4, "-->");
+            if ((flags & SVG_COMPACT_COMMENTS) != 0U) {
+                r = end;
+            }
+            else {
+                while (r < end) {
+                    *w++ = *r++;
+                }
+            }
+        }
+        else
+        if (strncmp(r, "<![CDATA[", 9U) == 0) {
+            const char* end = svgScanSkipPast(r + 9, "]]>");
+            while (r < end) {
+                *w++ = *r++;
+            }
+        }
+        else
+        if ((r[0] == '<') && ((r[1] == '?') || (r[1] == '!'))) {
+            // processing instructions and document type declarations (with a possible internal subset)
+            const char* end = svgScanDeclarationEnd(r);
+
+            while (r < end) {
+                *w++ = *r++;
+            }
+        }
+        else
+        if (r[0] == '<') {
+
+            const SVGTboolean closing = (r[1] == '/') ? SVGT_TRUE : SVGT_FALSE;
+            const char* name = r + (closing ? 2 : 1);
+            const char* nameEnd = name;
+            size_t nameLen;
+
+            while (svgScanNameChar(*nameEnd)) {
+                nameEnd++;
+            }
+            nameLen = (size_t)(nameEnd - name);
+
+            if ((!closing) &&
+                ((((flags & SVG_COMPACT_METADATA) != 0U) && (svgScanNameEqual(name, nameLen, "metadata") || svgScanNameEqual(name, nameLen, "title") || svgScanNameEqual(name, nameLen, "desc"))) ||
+                 (((flags & SVG_COMPACT_EDITOR) != 0U) && editorName(name, nameLen)))) {
+                // drop the whole element
+                r = elementEnd(r, name, nameLen);
+            }
+            else {
+                if (svgScanNameEqual(name, nameLen, "text")) {
+                    if (closing) {
+                        textDepth -= (textDepth > 0U) ? 1U : 0U;
+                    }
+                    else {
+                        const char* end = svgScanTagEnd(r);
+                        textDepth += ((end[-1] == '>') && (end[-2] == '/')) ? 0U : 1U;
+                    }
+                }
+                w = tagCopy(w, &r, flags);
+            }
+        }
+        else {
+            // text content
+            const char* end = r;
+            SVGTboolean blank = SVGT_TRUE;
+
+            while ((*end != '\0') && (*end != '<')) {
+                blank = (blank && isSpace(*end)) ? SVGT_TRUE : SVGT_FALSE;
+                end++;
+            }
+            if (blank && (textDepth == 0U) && ((flags & SVG_COMPACT_WHITESPACE) != 0U)) {
+                r = end;
+            }
+            else {
+                while (r < end) {
+                    *w++ = *r++;
+                }
+            }
+        }
+    }
+
+    *w = '\0';
+    return (size_t)(r - w);
+}
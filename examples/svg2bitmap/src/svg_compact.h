@@ -0,0 +1,70 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef SVG_COMPACT_H
+#define SVG_COMPACT_H
+
+/*!
+    \file svg_compact.h
+    \brief Removal of SVG content that is not needed for drawing, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// what can be removed from an SVG text
+typedef enum {
+    // XML comments
+    SVG_COMPACT_COMMENTS   = 1,
+    // <metadata>, <title> and <desc> elements
+    SVG_COMPACT_METADATA   = 2,
+    // editor specific elements and attributes (i.e. the ones within 'inkscape' and 'sodipodi' namespaces)
+    SVG_COMPACT_EDITOR     = 4,
+    // whitespace-only text between tags (outside of <text> elements, where it is significant)
+    SVG_COMPACT_WHITESPACE = 8,
+    // all of the above
+    SVG_COMPACT_ALL        = 15
+} SvgCompactFlag;
+
+// remove the content selected by the given flags (see SvgCompactFlag) from the given null-terminated SVG text;
+// compaction is done in place, and the number of reclaimed bytes is returned
+size_t svgCompact(char* xml,
+                  const SVGTuint flags);
+
+#endif /* SVG_COMPACT_H */
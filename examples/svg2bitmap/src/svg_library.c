@@ -0,0 +1,797 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file svg_library.c
+    \brief Shared libraries of definitions (gradients, patterns, symbols, ...) referenced by SVG documents, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "svg_library.h"
+#include "gzip_utils.h"
+#include "str_utils.h"
+#include "svg_compact.h"
+
+// marks an open element without an 'id' attribute
+#define SVG_LIBRARY_NO_DEF 0xFFFFFFFFU
+
+// position of an 'id' attribute value within a text
+typedef struct {
+    size_t start;
+    size_t length;
+} LibraryId;
+
+DYNARRAY_DECLARE(LibraryIdDynArray, LibraryId)
+
+// what is rewritten by a rewrite pass
+typedef enum {
+    // library text: 'id' attributes and local references ('#id') to them are prefixed by the library name
+    LIBRARY_REWRITE_DEFINITIONS = 0,
+    // document text: references to libraries ('name#id') become local references to the copied definitions
+    LIBRARY_REWRITE_DOCUMENT    = 1
+} LibraryRewriteMode;
+
+// state of a rewrite pass
+typedef struct {
+    LibraryRewriteMode mode;
+    // the library being rewritten (definitions mode), or the available libraries (document mode)
+    const SvgLibrary* libraries;
+    size_t librariesCount;
+    // document mode only: for each library, a flag for each definition that tells if it is referenced
+    SVGTubyte** used;
+    // rewritten text
+    StrBuffer out;
+    // number of rewritten references
+    SVGTuint resolved;
+    // set when an allocation fails
+    SVGTboolean outOfMemory;
+} LibraryRewrite;
+
+// append the given chars to the rewritten text
+static void rewriteEmit(LibraryRewrite* rw,
+                        const char* str,
+                        const size_t len) {
+
+    if ((!rw->outOfMemory) && (!strBufferAppend(&rw->out, str, len))) {
+        rw->outOfMemory = SVGT_TRUE;
+    }
+}
+
+// length of the name (or id) starting at the given position
+static size_t nameLength(const char* p,
+                         const char* end) {
+
+    const char* start = p;
+
+    while ((p < end) && svgScanNameChar(*p)) {
+        p++;
+    }
+
+    return (size_t)(p - start);
+}
+
+// find the definition having the given id (not null-terminated); -1 is returned if the id is not present
+static SVGTint libraryDefFind(const SvgLibrary* library,
+                              const char* id,
+                              const size_t idLen) {
+
+    SVGTint result = -1;
+
+    if ((library->ids.size > 0U) && (idLen > 0U) && (idLen < SVG_LIBRARY_ID_MAX_LENGTH)) {
+
+        char key[SVG_LIBRARY_ID_MAX_LENGTH];
+        HashedElementData* value;
+
+        (void)memcpy(key, id, idLen);
+        key[idLen] = '\0';
+        if (strHashMapGet((StringHashMap*)&library->ids, key, &value)) {
+            result = value->i;
+        }
+    }
+
+    return result;
+}
+
+// find the library referenced by the given name (not null-terminated), with or without the .svg/.svgz extension;
+// -1 is returned if there is no such library
+static SVGTint libraryFind(const SvgLibrary* libraries,
+                           const size_t librariesCount,
+                           const char* name,
+                           const size_t nameLen) {
+
+    SVGTint result = -1;
+
+    for (size_t i = 0U; (i < librariesCount) && (result < 0); ++i) {
+
+        const char* libName = libraries[i].name.name;
+        const size_t libNameLen = strlen(libName);
+
+        if ((nameLen >= libNameLen) && (strncmp(name, libName, libNameLen) == 0)) {
+
+            const char* ext = name + libNameLen;
+            const size_t extLen = nameLen - libNameLen;
+
+            if ((extLen == 0U) ||
+                ((extLen == 4U) && (strncmp(ext, ".svg", 4U) == 0)) ||
+                ((extLen == 5U) && (strncmp(ext, ".svgz", 5U) == 0))) {
+                result = (SVGTint)i;
+            }
+        }
+    }
+
+    return result;
+}
+
+// tell if the attribute value starting at the given (quote) position belongs to an 'id' attribute
+static SVGTboolean idAttributeValue(const char* tagStart,
+                                    const char* quote) {
+
+    const char* nameEnd = quote;
+
+    while ((nameEnd > tagStart) && (isSpace(nameEnd[-1]) || (nameEnd[-1] == '='))) {
+        nameEnd--;
+    }
+
+    return (((nameEnd - tagStart) > 3) && (nameEnd[-1] == 'd') && (nameEnd[-2] == 'i') && isSpace(nameEnd[-3])) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// rewrite the references found within the given region (a tag, or the content of a <style> element)
+static void regionRewrite(LibraryRewrite* rw,
+                          const char* p,
+                          const char* end,
+                          const SVGTboolean isTag) {
+
+    const char* tagStart = p;
+    // start of the text not yet emitted
+    const char* pending = p;
+
+    while (p < end) {
+
+        const char c = *p++;
+
+        // references can only start an attribute value or a 'url(' function argument
+        if ((c == '"') || (c == '\'') || (c == '(')) {
+
+            const char* q = p;
+
+            if (c == '(') {
+                // url( 'name#id' )
+                while ((q < end) && isSpace(*q)) {
+                    q++;
+                }
+                if ((q < end) && ((*q == '"') || (*q == '\''))) {
+                    q++;
+                }
+            }
+
+            if (rw->mode == LIBRARY_REWRITE_DOCUMENT) {
+
+                // name#id
+                const size_t nameLen = nameLength(q, end);
+                const char* id = q + nameLen + 1;
+
+                if ((nameLen > 0U) && (id < end) && (id[-1] == '#')) {
+
+                    const size_t idLen = nameLength(id, end);
+                    const SVGTint lib = libraryFind(rw->libraries, rw->librariesCount, q, nameLen);
+                    const SVGTint def = (lib >= 0) ? libraryDefFind(&rw->libraries[lib], id, idLen) : -1;
+
+                    if (def >= 0) {
+                        const char* libName = rw->libraries[lib].name.name;
+                        // name#id --> #name.id
+                        rewriteEmit(rw, pending, (size_t)(q - pending));
+                        rewriteEmit(rw, "#", 1U);
+                        rewriteEmit(rw, libName, strlen(libName));
+                        rewriteEmit(rw, ".", 1U);
+                        rewriteEmit(rw, id, idLen);
+                        rw->used[lib][def] = 1U;
+                        rw->resolved++;
+                        pending = p = id + idLen;
+                    }
+                }
+            }
+            else {
+                const SVGTboolean isRef = ((q < end) && (*q == '#')) ? SVGT_TRUE : SVGT_FALSE;
+                // #id (local reference), or the value of an 'id' attribute
+                const char* id = isRef ? (q + 1) : q;
+
+                if (isRef || (isTag && (c != '(') && idAttributeValue(tagStart, p - 1))) {
+
+                    const size_t idLen = nameLength(id, end);
+
+                    if (libraryDefFind(rw->libraries, id, idLen) >= 0) {
+                        const char* libName = rw->libraries->name.name;
+                        // #id --> #name.id, id="id" --> id="name.id"
+                        rewriteEmit(rw, pending, (size_t)(id - pending));
+                        rewriteEmit(rw, libName, strlen(libName));
+                        rewriteEmit(rw, ".", 1U);
+                        rw->resolved++;
+                        pending = id;
+                        p = id + idLen;
+                    }
+                }
+            }
+        }
+    }
+
+    rewriteEmit(rw, pending, (size_t)(end - pending));
+}
+
+// get the local name (i.e. without namespace prefix) of the tag starting at the given position
+static const char* tagLocalName(const char* tag,
+                                size_t* nameLen) {
+
+    const char* name = (tag[1] == '/') ? (tag + 2) : (tag + 1);
+    const char* localName = name;
+
+    while (svgScanNameChar(*name)) {
+        // skip namespace prefix
+        if (*name == ':') {
+            localName = name + 1;
+        }
+        name++;
+    }
+
+    *nameLen = (size_t)(name - localName);
+    return localName;
+}
+
+// rewrite the whole text; in document mode, 'insertAt' is set to the position (within the rewritten text) just
+// after the start tag of the outermost <svg> element (-1 if not present)
+static void textRewrite(LibraryRewrite* rw,
+                        const char* xml,
+                        SVGTint* insertAt) {
+
+    const char* p = xml;
+    SVGTboolean inStyle = SVGT_FALSE;
+    SVGTboolean rootFound = SVGT_FALSE;
+
+    *insertAt = -1;
+
+    while ((*p != '\0') && (!rw->outOfMemory)) {
+
+        const char* end;
+
+        if (*p != '<') {
+            // text content (references are rewritten within <style> elements only)
+            end = strchr(p, '<');
+            end = (end != NULL) ? end : (p + strlen(p));
+            if (inStyle) {
+                regionRewrite(rw, p, end, SVGT_FALSE);
+            }
+            else {
+                rewriteEmit(rw, p, (size_t)(end - p));
+            }
+        }
+        else
+        if (strncmp(p, "<!--", 4U) == 0) {
+            end = svgScanSkipPast(p + 4, "-->");
+            rewriteEmit(rw, p, (size_t)(end - p));
+        }
+        else
+        if (strncmp(p, "<![CDATA[", 9U) == 0) {
+            end = svgScanSkipPast(p + 9, "]]>");
+            if (inStyle) {
+                regionRewrite(rw, p, end, SVGT_FALSE);
+            }
+            else {
+                rewriteEmit(rw, p, (size_t)(end - p));
+            }
+        }
+        else
+        if ((p[1] == '?') || (p[1] == '!')) {
+            // processing instructions and document type declarations (with a possible internal subset)
+            end = svgScanDeclarationEnd(p);
+            rewriteEmit(rw, p, (size_t)(end - p));
+        }
+        else {
+            size_t nameLen;
+            const char* name = tagLocalName(p, &nameLen);
+            SVGTboolean selfClosing;
+
+            end = svgScanTagEnd(p);
+            selfClosing = (((end - p) >= 2) && (end[-1] == '>') && (end[-2] == '/')) ? SVGT_TRUE : SVGT_FALSE;
+
+            regionRewrite(rw, p, end, SVGT_TRUE);
+            if (svgScanNameEqual(name, nameLen, "style")) {
+                inStyle = ((p[1] != '/') && (!selfClosing)) ? SVGT_TRUE : SVGT_FALSE;
+            }
+            if ((p[1] != '/') && (!rootFound)) {
+                // definitions are copied at the beginning of the outermost <svg> element
+                if (svgScanNameEqual(name, nameLen, "svg") && (!selfClosing) && (end[-1] == '>')) {
+                    *insertAt = (SVGTint)rw->out.size;
+                }
+                rootFound = SVGT_TRUE;
+            }
+        }
+
+        p = end;
+    }
+}
+
+// get the value of the 'id' attribute of the start tag [p, end), if present
+static SVGTboolean tagIdGet(const char* p,
+                            const char* end,
+                            const char** id,
+                            size_t* idLen) {
+
+    SVGTboolean found = SVGT_FALSE;
+    size_t nameLen;
+
+    // skip the element name
+    p = tagLocalName(p, &nameLen) + nameLen;
+
+    while ((p < end) && (!found)) {
+
+        const char* name;
+        const char* nameEnd;
+
+        while ((p < end) && (!svgScanNameChar(*p))) {
+            p++;
+        }
+        name = p;
+        while ((p < end) && svgScanNameChar(*p)) {
+            p++;
+        }
+        nameEnd = p;
+        while ((p < end) && (isSpace(*p) || (*p == '='))) {
+            p++;
+        }
+
+        if ((p < end) && ((*p == '"') || (*p == '\''))) {
+
+            const char quote = *p++;
+            const char* value = p;
+
+            while ((p < end) && (*p != quote)) {
+                p++;
+            }
+            if (svgScanNameEqual(name, (size_t)(nameEnd - name), "id") && (p > value)) {
+                *id = value;
+                *idLen = (size_t)(p - value);
+                found = SVGT_TRUE;
+            }
+            // skip the closing quote
+            p += (p < end) ? 1 : 0;
+        }
+    }
+
+    return found;
+}
+
+// collect the elements having an 'id' attribute: their span goes into the library definitions, the position
+// of their id into the given array (both in document order)
+static SVGTboolean elementsIndex(SvgLibrary* library,
+                                 LibraryIdDynArray* ids) {
+
+    const char* xml = library->xml;
+    const char* p = xml;
+    const size_t xmlLen = strlen(xml);
+    // currently open elements (definition index, or SVG_LIBRARY_NO_DEF)
+    SvgLibraryRefDynArray open;
+    SVGTboolean ok = SVGT_TRUE;
+
+    DYNARRAY_INIT(open)
+    library->defs.size = 0U;
+    ids->size = 0U;
+
+    while ((*p != '\0') && ok) {
+
+        const char* end;
+
+        if (*p != '<') {
+            end = strchr(p, '<');
+            end = (end != NULL) ? end : (xml + xmlLen);
+        }
+        else
+        if (strncmp(p, "<!--", 4U) == 0) {
+            end = svgScanSkipPast(p + 4, "-->");
+        }
+        else
+        if (strncmp(p, "<![CDATA[", 9U) == 0) {
+            end = svgScanSkipPast(p + 9, "]]>");
+        }
+        else
+        if ((p[1] == '?') || (p[1] == '!')) {
+            end = svgScanDeclarationEnd(p);
+        }
+        else {
+            end = svgScanTagEnd(p);
+
+            if (p[1] == '/') {
+                // closing tag
+                if (open.size > 0U) {
+                    const SVGTuint defIdx = open.data[--open.size];
+                    if (defIdx != SVG_LIBRARY_NO_DEF) {
+                        library->defs.data[defIdx].length = (size_t)(end - xml) - library->defs.data[defIdx].start;
+                    }
+                }
+            }
+            else {
+                const char* id;
+                size_t idLen;
+                const SVGTboolean selfClosing = (((end - p) >= 2) && (end[-1] == '>') && (end[-2] == '/')) ? SVGT_TRUE : SVGT_FALSE;
+                SVGTuint defIdx = SVG_LIBRARY_NO_DEF;
+
+                if (tagIdGet(p, end - 1, &id, &idLen)) {
+
+                    const size_t defsCount = library->defs.size;
+                    const size_t idsCount = ids->size;
+                    // unclosed elements extend up to the end of the text
+                    const SvgLibraryDef def = { (size_t)(p - xml), selfClosing ? (size_t)(end - p) : (xmlLen - (size_t)(p - xml)), 0U, 0U };
+                    const LibraryId libId = { (size_t)(id - xml), idLen };
+
+                    DYNARRAY_PUSH_BACK(library->defs, SvgLibraryDef, def)
+                    DYNARRAY_PUSH_BACK(*ids, LibraryId, libId)
+                    ok = ((library->defs.size > defsCount) && (ids->size > idsCount)) ? SVGT_TRUE : SVGT_FALSE;
+                    defIdx = (SVGTuint)defsCount;
+                }
+                if (!selfClosing) {
+                    const size_t openCount = open.size;
+                    DYNARRAY_PUSH_BACK(open, SVGTuint, defIdx)
+                    ok = ok && (open.size > openCount);
+                }
+            }
+        }
+
+        p = end;
+    }
+
+    DYNARRAY_DESTROY(open)
+    return ok;
+}
+
+// register the ids of the library definitions
+static SVGTErrorCode idsRegister(SvgLibrary* library,
+                                 const LibraryIdDynArray* ids) {
+
+    size_t total = 0U;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    for (size_t i = 0U; i < ids->size; ++i) {
+        total += ids->data[i].length + 1U;
+    }
+
+    if (((library->idsBuffer = memMalloc(MAX(total, 1U))) != NULL) &&
+        ((err = strHashMapInit(&library->ids, (SVGTuint)MAX(ids->size * 2U, 16U))) == SVGT_NO_ERROR)) {
+
+        char* key = library->idsBuffer;
+
+        for (size_t i = 0U; (i < ids->size) && (err == SVGT_NO_ERROR); ++i) {
+
+            HashedElementData* existing;
+
+            (void)memcpy(key, &library->xml[ids->data[i].start], ids->data[i].length);
+            key[ids->data[i].length] = '\0';
+            // in case of duplicated ids, the first definition wins
+            if ((library->ids.size == 0U) || (!strHashMapGet(&library->ids, key, &existing))) {
+                HashedElementData value;
+                value.i = (SVGTint)i;
+                err = strHashMapPut(&library->ids, key, value);
+            }
+            key += ids->data[i].length + 1U;
+        }
+    }
+    else {
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    return err;
+}
+
+// find the definitions referenced by each definition (i.e. '#name.id' references within its span)
+static SVGTErrorCode refsCollect(SvgLibrary* library) {
+
+    const char* libName = library->name.name;
+    const size_t libNameLen = strlen(libName);
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    for (size_t i = 0U; (i < library->defs.size) && (err == SVGT_NO_ERROR); ++i) {
+
+        SvgLibraryDef* def = &library->defs.data[i];
+        const char* p = &library->xml[def->start];
+        const char* end = p + def->length;
+
+        def->firstRef = (SVGTuint)library->refs.size;
+        while ((p < end) && (err == SVGT_NO_ERROR)) {
+
+            const char* hash = (const char*)memchr(p, '#', (size_t)(end - p));
+
+            if ((hash != NULL) && ((size_t)(end - hash) > (libNameLen + 1U)) &&
+                (strncmp(hash + 1, libName, libNameLen) == 0) && (hash[libNameLen + 1U] == '.')) {
+
+                const char* id = hash + libNameLen + 2U;
+                const size_t idLen = nameLength(id, end);
+                const SVGTint ref = libraryDefFind(library, id, idLen);
+
+                if ((ref >= 0) && ((size_t)ref != i)) {
+                    const size_t refsCount = library->refs.size;
+                    DYNARRAY_PUSH_BACK(library->refs, SVGTuint, (SVGTuint)ref)
+                    err = (library->refs.size > refsCount) ? SVGT_NO_ERROR : SVGT_OUT_OF_MEMORY_ERROR;
+                }
+                p = id + idLen;
+            }
+            else {
+                p = (hash != NULL) ? (hash + 1) : end;
+            }
+        }
+        def->refsCount = (SVGTuint)library->refs.size - def->firstRef;
+    }
+
+    return err;
+}
+
+void svgLibraryInit(SvgLibrary* library,
+                    const char* fileName) {
+
+    (void)memset(library, 0, sizeof(SvgLibrary));
+    (void)strcpy(library->fileName.name, fileName);
+    // ensure that every slash present within the path, will be set according to the current operating system type
+    fixPath(library->fileName.name, SVGT_FALSE);
+    // e.g. /data/icons.svg --> icons
+    extractFileName(library->name.name, library->fileName.name, SVGT_FALSE);
+    DYNARRAY_INIT(library->defs)
+    DYNARRAY_INIT(library->refs)
+}
+
+SVGTErrorCode svgLibraryLoad(SvgLibrary* library,
+                             const SVGTboolean compact) {
+
+    size_t fileSize;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    LibraryIdDynArray ids;
+    // add a trailing '\0'
+    char* xml = (char*)loadFileInflated(library->fileName.name, 1U, &fileSize, &err);
+
+    DYNARRAY_INIT(ids)
+
+    if (xml != NULL) {
+
+        // remove content not needed for drawing
+        if (compact) {
+            (void)svgCompact(xml, SVG_COMPACT_ALL);
+        }
+        library->xml = xml;
+
+        // register the original ids
+        if (elementsIndex(library, &ids) && ((err = idsRegister(library, &ids)) == SVGT_NO_ERROR)) {
+
+            SVGTint insertAt;
+            LibraryRewrite rw = { LIBRARY_REWRITE_DEFINITIONS, library, 1U, NULL, { NULL, 0U, 0U }, 0U, SVGT_FALSE };
+
+            // prefix ids and local references by the library name
+            textRewrite(&rw, xml, &insertAt);
+            // ensure a valid (empty) result even for an empty text
+            rewriteEmit(&rw, "", 0U);
+            if (!rw.outOfMemory) {
+                memFree(xml);
+                library->xml = rw.out.data;
+                // index the definitions within the rewritten text (same elements, in the same order)
+                if (!elementsIndex(library, &ids)) {
+                    err = SVGT_OUT_OF_MEMORY_ERROR;
+                }
+                else {
+                    err = refsCollect(library);
+                }
+            }
+            else {
+                memFree(rw.out.data);
+                err = SVGT_OUT_OF_MEMORY_ERROR;
+            }
+        }
+        else {
+            err = (err != SVGT_NO_ERROR) ? err : SVGT_OUT_OF_MEMORY_ERROR;
+        }
+    }
+
+    DYNARRAY_DESTROY(ids)
+    return err;
+}
+
+void svgLibraryDestroy(SvgLibrary* library) {
+
+    if (library->xml != NULL) {
+        memFree(library->xml);
+        library->xml = NULL;
+    }
+    if (library->idsBuffer != NULL) {
+        memFree(library->idsBuffer);
+        library->idsBuffer = NULL;
+    }
+    strHashMapDestroy(&library->ids);
+    DYNARRAY_DESTROY(library->defs)
+    DYNARRAY_DESTROY(library->refs)
+    DYNARRAY_INIT(library->defs)
+    DYNARRAY_INIT(library->refs)
+}
+
+// mark the definitions referenced (directly or not) by the already marked ones
+static SVGTboolean usedClosure(const SvgLibrary* library,
+                               SVGTubyte* used) {
+
+    SvgLibraryRefDynArray pending;
+    SVGTboolean ok = SVGT_TRUE;
+
+    DYNARRAY_INIT(pending)
+    for (size_t i = 0U; (i < library->defs.size) && ok; ++i) {
+        if (used[i]) {
+            const size_t pendingCount = pending.size;
+            DYNARRAY_PUSH_BACK(pending, SVGTuint, (SVGTuint)i)
+            ok = (pending.size > pendingCount) ? SVGT_TRUE : SVGT_FALSE;
+        }
+    }
+
+    while ((pending.size > 0U) && ok) {
+
+        const SvgLibraryDef* def = &library->defs.data[pending.data[--pending.size]];
+
+        for (SVGTuint i = 0U; (i < def->refsCount) && ok; ++i) {
+
+            const SVGTuint ref = library->refs.data[def->firstRef + i];
+
+            if (!used[ref]) {
+                const size_t pendingCount = pending.size;
+                used[ref] = 1U;
+                DYNARRAY_PUSH_BACK(pending, SVGTuint, ref)
+                ok = (pending.size > pendingCount) ? SVGT_TRUE : SVGT_FALSE;
+            }
+        }
+    }
+
+    DYNARRAY_DESTROY(pending)
+    return ok;
+}
+
+// append the used definitions (and the ones they reference) to the given buffer; definitions nested within other
+// used ones are already included by their ancestors
+static SVGTboolean usedDefsAppend(const SvgLibrary* library,
+                                  SVGTubyte* used,
+                                  StrBuffer* buffer) {
+
+    size_t copiedEnd = 0U;
+    SVGTboolean ok = usedClosure(library, used);
+
+    // definitions are sorted by start position
+    for (size_t i = 0U; (i < library->defs.size) && ok; ++i) {
+
+        const SvgLibraryDef* def = &library->defs.data[i];
+
+        if (used[i] && (def->start >= copiedEnd)) {
+            ok = strBufferAppend(buffer, &library->xml[def->start], def->length);
+            copiedEnd = def->start + def->length;
+        }
+    }
+
+    return ok;
+}
+
+SVGTErrorCode svgLibrariesApply(const char* xml,
+                                const SvgLibraryDynArray* libraries,
+                                char** result,
+                                SVGTuint* resolved) {
+
+    SVGTint insertAt = -1;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    LibraryRewrite rw = { LIBRARY_REWRITE_DOCUMENT, libraries->data, libraries->size, NULL, { NULL, 0U, 0U }, 0U, SVGT_FALSE };
+
+    *result = NULL;
+    *resolved = 0U;
+
+    // a flag for each definition of each library
+    if ((rw.used = memCalloc(MAX(libraries->size, 1U), sizeof(SVGTubyte*))) != NULL) {
+        for (size_t i = 0U; (i < libraries->size) && (!rw.outOfMemory); ++i) {
+            rw.used[i] = memCalloc(MAX(libraries->data[i].defs.size, 1U), sizeof(SVGTubyte));
+            rw.outOfMemory = (rw.used[i] == NULL) ? SVGT_TRUE : SVGT_FALSE;
+        }
+    }
+    else {
+        rw.outOfMemory = SVGT_TRUE;
+    }
+
+    if (!rw.outOfMemory) {
+        // turn 'name#id' references into local ones, keeping track of the referenced definitions
+        textRewrite(&rw, xml, &insertAt);
+        if (insertAt < 0) {
+            // there is no place where definitions can be copied, so local references would be dangling: leave the text untouched
+            rw.out.size = 0U;
+            rw.resolved = 0U;
+            rewriteEmit(&rw, xml, strlen(xml));
+        }
+        // ensure a valid (empty) result even for an empty text
+        rewriteEmit(&rw, "", 0U);
+    }
+
+    if ((!rw.outOfMemory) && (rw.resolved > 0U) && (insertAt >= 0)) {
+
+        StrBuffer defs = { NULL, 0U, 0U };
+        SVGTboolean ok = strBufferAppend(&defs, "<defs>", 6U);
+
+        for (size_t i = 0U; (i < libraries->size) && ok; ++i) {
+            ok = usedDefsAppend(&libraries->data[i], rw.used[i], &defs);
+        }
+        ok = ok && strBufferAppend(&defs, "</defs>", 7U);
+
+        if (ok) {
+            // place the definitions just after the start tag of the outermost <svg> element
+            char* linked = memMalloc(rw.out.size + defs.size + 1U);
+
+            if (linked != NULL) {
+                (void)memcpy(linked, rw.out.data, (size_t)insertAt);
+                (void)memcpy(&linked[insertAt], defs.data, defs.size);
+                (void)memcpy(&linked[(size_t)insertAt + defs.size], &rw.out.data[insertAt], (rw.out.size - (size_t)insertAt) + 1U);
+                memFree(rw.out.data);
+                rw.out.data = linked;
+                rw.out.size += defs.size;
+            }
+            else {
+                rw.outOfMemory = SVGT_TRUE;
+            }
+        }
+        else {
+            rw.outOfMemory = SVGT_TRUE;
+        }
+
+        if (defs.data != NULL) {
+            memFree(defs.data);
+        }
+    }
+
+    if (!rw.outOfMemory) {
+        *result = rw.out.data;
+        *resolved = rw.resolved;
+    }
+    else {
+        if (rw.out.data != NULL) {
+            memFree(rw.out.data);
+        }
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    // release flags
+    if (rw.used != NULL) {
+        for (size_t i = 0U; i < libraries->size; ++i) {
+            if (rw.used[i] != NULL) {
+                memFree(rw.used[i]);
+            }
+        }
+        memFree(rw.used);
+    }
+
+    return err;
+}
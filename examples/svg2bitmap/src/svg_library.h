@@ -0,0 +1,81 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef SVG_LIBRARY_H
+#define SVG_LIBRARY_H
+
+/*!
+    \file svg_library.h
+    \brief Shared libraries of definitions (gradients, patterns, symbols, ...) referenced by SVG documents, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// maximum length of an id that can be referenced within a library
+#define SVG_LIBRARY_ID_MAX_LENGTH 256U
+
+// set up a library for the given SVG file, without loading it; the library is named after the file, without
+// extension (e.g. 'icons' for /data/icons.svg)
+void svgLibraryInit(SvgLibrary* library,
+                    const char* fileName);
+
+// load the library file (gzip compressed files are accepted too) and index its definitions, i.e. all the elements
+// having an 'id' attribute; ids, and the local references to them, are prefixed by the library name (e.g. 'star'
+// becomes 'icons.star'), so that they cannot clash with the ones of the documents; if 'compact' is true, content
+// not needed for drawing is removed too (see svgCompact)
+SVGTErrorCode svgLibraryLoad(SvgLibrary* library,
+                             const SVGTboolean compact);
+
+// release the library content
+void svgLibraryDestroy(SvgLibrary* library);
+
+// resolve the references to the given libraries, in the format 'name#id' (e.g. href="icons#star" or
+// fill="url(icons#gradient)"; 'name.svg#id' is accepted too), found within attribute values and <style> elements;
+// referenced definitions (and the ones they reference in turn) are copied into a <defs> element placed at the
+// beginning of the outermost <svg> element, and references are turned into local ones
+// the result is a new (null-terminated) buffer that must be released by the caller, 'resolved' is the
+// number of resolved references; if the text has no outermost <svg> element, it is returned untouched (and
+// 'resolved' is 0)
+SVGTErrorCode svgLibrariesApply(const char* xml,
+                                const SvgLibraryDynArray* libraries,
+                                char** result,
+                                SVGTuint* resolved);
+
+#endif /* SVG_LIBRARY_H */
@@ -0,0 +1,1413 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file svg_scan.c
+    \brief Lightweight scanning of SVG text, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "svg_scan.h"
+#include "arena.h"
+#include "config.h"
+#include "str_hashmap.h"
+#include "str_utils.h"
+
+// SIMD instruction set used to search delimiters
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define SVG_SCAN_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #define SVG_SCAN_NEON
+    #include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && (defined(SVG_SCAN_SSE2) || defined(SVG_SCAN_NEON))
+    #include <intrin.h>
+#endif
+
+// tell if the given char is a decimal digit (a single comparison)
+#define SCAN_DIGIT(_c) ((SVGTuint)((_c) - '0') <= 9U)
+
+// saturation value for counters
+#define SVG_SCAN_COUNT_MAX 0xFFFFFFFFU
+
+// <use> expansion state of an element
+#define SCAN_ELEMENT_UNVISITED 0U
+#define SCAN_ELEMENT_VISITING  1U
+#define SCAN_ELEMENT_DONE      2U
+
+// an element, as seen by the <use> expansion
+typedef struct {
+    // index of the first element that follows the subtree rooted at this element
+    SVGTuint end;
+    // index of the first <use> reference at or after this element (in document order)
+    SVGTuint firstUse;
+    // expansion state, and index of the next <use> reference to visit within the subtree
+    SVGTuint state;
+    SVGTuint cursor;
+    // number of elements instantiated by referencing this element
+    uint64_t instances;
+} ScanElement;
+
+// a local <use> reference
+typedef struct {
+    // index of the <use> element
+    SVGTuint elemIdx;
+    // referenced id (not null-terminated), and the index of the referenced element (-1 if unresolved)
+    const char* ref;
+    size_t refLen;
+    SVGTint target;
+} ScanUse;
+
+DYNARRAY_DECLARE(ScanElementDynArray, ScanElement)
+DYNARRAY_DECLARE(ScanUseDynArray, ScanUse)
+DYNARRAY_DECLARE(ScanIdxDynArray, SVGTuint)
+
+// state needed to expand <use> references
+typedef struct {
+    ScanElementDynArray elements;
+    ScanUseDynArray uses;
+    // currently open elements
+    ScanIdxDynArray openElements;
+    // id --> element index
+    StringHashMap ids;
+    // storage for ids
+    Arena arena;
+    // set when an allocation fails; from then on, elements are not tracked anymore
+    SVGTboolean outOfMemory;
+} ScanContext;
+
+// an attribute of a start tag (name and value are not null-terminated)
+typedef struct {
+    const char* name;
+    size_t nameLen;
+    const char* value;
+    size_t valueLen;
+} ScanAttribute;
+
+// 'id' and 'href' attributes of a start tag (not null-terminated)
+typedef struct {
+    const char* id;
+    size_t idLen;
+    const char* href;
+    size_t hrefLen;
+} ScanTagRefs;
+
+#if defined(SVG_SCAN_SSE2)
+// index of the lowest set bit of the given (non-zero) mask
+static SVGTuint lowestBitIndex(const SVGTuint mask) {
+
+#if defined(_MSC_VER)
+    unsigned long idx;
+
+    (void)_BitScanForward(&idx, mask);
+    return (SVGTuint)idx;
+#else
+    return (SVGTuint)__builtin_ctz(mask);
+#endif
+}
+#elif defined(SVG_SCAN_NEON)
+// index of the lowest set bit of the given (non-zero) mask
+static SVGTuint lowestBitIndex(const uint64_t mask) {
+
+#if defined(_MSC_VER)
+    unsigned long idx;
+
+    (void)_BitScanForward64(&idx, mask);
+    return (SVGTuint)idx;
+#else
+    return (SVGTuint)__builtin_ctzll(mask);
+#endif
+}
+#endif
+
+// get the first position within [p, end) holding the given char; end is returned if the char is not present
+static const char* charFind(const char* p,
+                            const char* end,
+                            const char c) {
+
+    // memchr is already vectorized by the C runtime
+    const char* found = (const char*)memchr(p, c, (size_t)(end - p));
+
+    return (found != NULL) ? found : end;
+}
+
+// get the first position within [p, end) holding one of the given chars; end is returned if none of them is present
+static const char* charsFind(const char* p,
+                             const char* end,
+                             const char c0,
+                             const char c1,
+                             const char c2) {
+
+    SVGTboolean found = SVGT_FALSE;
+
+#if defined(SVG_SCAN_SSE2)
+    const __m128i v0 = _mm_set1_epi8(c0);
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+
+    // 16 chars at a time
+    while ((!found) && ((end - p) >= 16)) {
+
+        const __m128i v = _mm_loadu_si128((const __m128i*)p);
+        const __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, v0), _mm_cmpeq_epi8(v, v1)), _mm_cmpeq_epi8(v, v2));
+        const SVGTuint mask = (SVGTuint)_mm_movemask_epi8(eq);
+
+        if (mask != 0U) {
+            p += lowestBitIndex(mask);
+            found = SVGT_TRUE;
+        }
+        else {
+            p += 16;
+        }
+    }
+#elif defined(SVG_SCAN_NEON)
+    const uint8x16_t v0 = vdupq_n_u8((uint8_t)c0);
+    const uint8x16_t v1 = vdupq_n_u8((uint8_t)c1);
+    const uint8x16_t v2 = vdupq_n_u8((uint8_t)c2);
+
+    // 16 chars at a time
+    while ((!found) && ((end - p) >= 16)) {
+
+        const uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        const uint8x16_t eq = vorrq_u8(vorrq_u8(vceqq_u8(v, v0), vceqq_u8(v, v1)), vceqq_u8(v, v2));
+        // narrow the comparison result to 4 bits per char
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+
+        if (mask != 0U) {
+            p += lowestBitIndex(mask) >> 2;
+            found = SVGT_TRUE;
+        }
+        else {
+            p += 16;
+        }
+    }
+#endif
+
+    // remaining chars (or the whole range, if SIMD is not available)
+    while ((!found) && (p < end)) {
+        if ((*p == c0) || (*p == c1) || (*p == c2)) {
+            found = SVGT_TRUE;
+        }
+        else {
+            p++;
+        }
+    }
+
+    return p;
+}
+
+// get the position just after the given terminator, without going past the given end
+static const char* boundedSkipPast(const char* p,
+                                   const char* end,
+                                   const char* terminator) {
+
+    const size_t len = strlen(terminator);
+    SVGTboolean found = SVGT_FALSE;
+
+    while ((!found) && ((size_t)(end - p) >= len)) {
+        // jump to the next candidate
+        p = charFind(p, end - len + 1, terminator[0]);
+        if (((size_t)(end - p) >= len) && (memcmp(p, terminator, len) == 0)) {
+            found = SVGT_TRUE;
+        }
+        else {
+            p++;
+        }
+    }
+
+    return found ? (p + len) : end;
+}
+
+// get the position just after the end of the tag starting at the given position, without going past the given end
+// (attribute values are honored)
+static const char* boundedTagEnd(const char* p,
+                                 const char* end) {
+
+    SVGTboolean found = SVGT_FALSE;
+
+    while ((!found) && (p < end)) {
+        // jump to the next tag terminator or attribute value
+        p = charsFind(p, end, '>', '"', '\'');
+        if (p < end) {
+            if (*p != '>') {
+                // skip the whole attribute value, up to the closing quote
+                p = charFind(p + 1, end, *p);
+            }
+            else {
+                found = SVGT_TRUE;
+            }
+            p += (p < end) ? 1 : 0;
+        }
+    }
+
+    return p;
+}
+
+// get the position just after the end of the processing instruction or markup declaration starting at the given
+// position, without going past the given end
+static const char* boundedDeclarationEnd(const char* p,
+                                         const char* end) {
+
+    // a declaration with an internal subset ends with "]>"
+    const char* subset = charsFind(p, end, '>', '[', '>');
+
+    return ((subset < end) && (*subset == '[')) ? boundedSkipPast(subset, end, "]>") : boundedTagEnd(p, end);
+}
+
+// skip a number (optional sign, integer part, fractional part, exponent); it returns the given position if no number is present
+static const char* numberSkip(const char* p,
+                             const char* end) {
+
+    const char* start = p;
+    const char* digits;
+
+    if ((p < end) && ((*p == '+') || (*p == '-'))) {
+        p++;
+    }
+    digits = p;
+    while ((p < end) && SCAN_DIGIT(*p)) {
+        p++;
+    }
+    if ((p < end) && (*p == '.')) {
+        p++;
+        while ((p < end) && SCAN_DIGIT(*p)) {
+            p++;
+        }
+    }
+    // at least a digit is required
+    if ((p == digits) || ((p == digits + 1) && (*digits == '.'))) {
+        p = start;
+    }
+    else
+    if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+        // exponent
+        const char* e = p + 1;
+        if ((e < end) && ((*e == '+') || (*e == '-'))) {
+            e++;
+        }
+        if ((e < end) && SCAN_DIGIT(*e)) {
+            while ((e < end) && SCAN_DIGIT(*e)) {
+                e++;
+            }
+            p = e;
+        }
+    }
+
+    return p;
+}
+
+// number of arguments taken by the given path command (a negative number if the char is not a command)
+static SVGTint pathCommandArgs(const char c) {
+
+    SVGTint n;
+
+    switch (c) {
+        case 'Z': case 'z':
+            n = 0;
+            break;
+        case 'H': case 'h': case 'V': case 'v':
+            n = 1;
+            break;
+        case 'M': case 'm': case 'L': case 'l': case 'T': case 't':
+            n = 2;
+            break;
+        case 'S': case 's': case 'Q': case 'q':
+            n = 4;
+            break;
+        case 'C': case 'c':
+            n = 6;
+            break;
+        case 'A': case 'a':
+            n = 7;
+            break;
+        default:
+            n = -1;
+            break;
+    }
+
+    return n;
+}
+
+// count the segments of the given path data (not null-terminated)
+static SVGTuint pathSegmentsCount(const char* p,
+                                  const char* end) {
+
+    SVGTuint result = 0U;
+    SVGTint args = -1;
+    SVGTuint numbers = 0U;
+
+    while (p < end) {
+
+        const char c = *p;
+
+        // numbers are by far the most frequent tokens, so they are checked first
+        if (SCAN_DIGIT(c) || (c == '.') || (c == '-') || (c == '+')) {
+            const char* next = numberSkip(p, end);
+            if (next > p) {
+                numbers++;
+                p = next;
+            }
+            else {
+                // malformed content
+                p++;
+            }
+        }
+        else {
+            const SVGTint cmdArgs = pathCommandArgs(c);
+
+            if (cmdArgs >= 0) {
+                // flush the previous command
+                if (args > 0) {
+                    result += MAX(numbers / (SVGTuint)args, 1U);
+                }
+                else
+                if (args == 0) {
+                    result++;
+                }
+                args = cmdArgs;
+                numbers = 0U;
+            }
+            // commands, separators (and malformed content) are single chars
+            p++;
+        }
+    }
+    // flush the last command
+    if (args > 0) {
+        result += MAX(numbers / (SVGTuint)args, 1U);
+    }
+    else
+    if (args == 0) {
+        result++;
+    }
+
+    return result;
+}
+
+// count the segments of the given <polyline>/<polygon> points (not null-terminated), one for each coordinate pair
+static SVGTuint pointsSegmentsCount(const char* p,
+                                    const char* end) {
+
+    SVGTuint numbers = 0U;
+
+    while (p < end) {
+
+        const char* next = numberSkip(p, end);
+
+        if (next > p) {
+            numbers++;
+            p = next;
+        }
+        else {
+            // separators (and malformed content) are single chars
+            p++;
+        }
+    }
+
+    return numbers / 2U;
+}
+
+// add two counters, saturating the result at SVG_SCAN_COUNT_MAX
+static SVGTuint countAdd(const SVGTuint a,
+                         const SVGTuint b) {
+
+    return (SVGTuint)MIN((uint64_t)a + (uint64_t)b, (uint64_t)SVG_SCAN_COUNT_MAX);
+}
+
+// update statistics according to the given element (local) name
+static void elementStatsUpdate(SvgScanStats* stats,
+                               const char* name,
+                               const size_t nameLen) {
+
+    if (svgScanNameEqual(name, nameLen, "g") || svgScanNameEqual(name, nameLen, "svg") || svgScanNameEqual(name, nameLen, "a") ||
+        svgScanNameEqual(name, nameLen, "switch") || svgScanNameEqual(name, nameLen, "symbol") || svgScanNameEqual(name, nameLen, "defs")) {
+        stats->groupsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "path")) {
+        stats->shapesCount++;
+        stats->pathsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "rect") || svgScanNameEqual(name, nameLen, "circle") || svgScanNameEqual(name, nameLen, "ellipse") ||
+        svgScanNameEqual(name, nameLen, "line") || svgScanNameEqual(name, nameLen, "polyline") || svgScanNameEqual(name, nameLen, "polygon")) {
+        stats->shapesCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "text") || svgScanNameEqual(name, nameLen, "tspan") || svgScanNameEqual(name, nameLen, "textPath")) {
+        stats->textRunsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "image")) {
+        stats->imagesCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "use")) {
+        stats->usesCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "linearGradient") || svgScanNameEqual(name, nameLen, "radialGradient")) {
+        stats->gradientsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "pattern")) {
+        stats->patternsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "mask")) {
+        stats->masksCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "clipPath")) {
+        stats->clipPathsCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "filter")) {
+        stats->filtersCount++;
+    }
+    else
+    if (svgScanNameEqual(name, nameLen, "style")) {
+        stats->stylesCount++;
+    }
+    else
+    if ((nameLen > 2U) && (name[0] == 'f') && (name[1] == 'e') &&
+        // light sources and transfer functions are children of primitives
+        (!svgScanNameEqual(name, nameLen, "feDistantLight")) && (!svgScanNameEqual(name, nameLen, "fePointLight")) && (!svgScanNameEqual(name, nameLen, "feSpotLight")) &&
+        (!svgScanNameEqual(name, nameLen, "feFuncR")) && (!svgScanNameEqual(name, nameLen, "feFuncG")) && (!svgScanNameEqual(name, nameLen, "feFuncB")) &&
+        (!svgScanNameEqual(name, nameLen, "feFuncA")) && (!svgScanNameEqual(name, nameLen, "feMergeNode"))) {
+        stats->filterPrimitivesCount++;
+    }
+}
+
+// get the next attribute (with a quoted value) of a start tag, advancing the given position up to the given end;
+// SVGT_FALSE is returned if there are no more attributes
+static SVGTboolean attributeNext(const char** pos,
+                                 const char* end,
+                                 ScanAttribute* attr) {
+
+    const char* p = *pos;
+    SVGTboolean found = SVGT_FALSE;
+
+    while ((p < end) && (!found)) {
+
+        const char* name;
+        const char* nameEnd;
+
+        while ((p < end) && (!svgScanNameChar(*p))) {
+            p++;
+        }
+        name = p;
+        while ((p < end) && svgScanNameChar(*p)) {
+            p++;
+        }
+        nameEnd = p;
+        while ((p < end) && (isSpace(*p) || (*p == '='))) {
+            p++;
+        }
+
+        if ((p < end) && ((*p == '"') || (*p == '\''))) {
+
+            const char quote = *p++;
+
+            attr->name = name;
+            attr->nameLen = (size_t)(nameEnd - name);
+            attr->value = p;
+            p = charFind(p, end, quote);
+            attr->valueLen = (size_t)(p - attr->value);
+            // skip the closing quote
+            p += (p < end) ? 1 : 0;
+            found = SVGT_TRUE;
+        }
+    }
+
+    *pos = p;
+    return found;
+}
+
+// scan the attributes of a start tag, from the end of the element name to the end of the tag
+static void attributesScan(SvgScanStats* stats,
+                           const char* p,
+                           const char* end,
+                           const SVGTboolean isPath,
+                           const SVGTboolean isPoly,
+                           ScanTagRefs* refs) {
+
+    ScanAttribute attr;
+
+    while (attributeNext(&p, end, &attr)) {
+
+        stats->attributesCount++;
+        stats->maxAttributeLength = MAX(stats->maxAttributeLength, attr.valueLen);
+        if (isPath && svgScanNameEqual(attr.name, attr.nameLen, "d")) {
+            stats->pathSegmentsCount = countAdd(stats->pathSegmentsCount, pathSegmentsCount(attr.value, attr.value + attr.valueLen));
+        }
+        else
+        if (isPoly && svgScanNameEqual(attr.name, attr.nameLen, "points")) {
+            stats->pathSegmentsCount = countAdd(stats->pathSegmentsCount, pointsSegmentsCount(attr.value, attr.value + attr.valueLen));
+        }
+        else
+        if (svgScanNameEqual(attr.name, attr.nameLen, "id")) {
+            refs->id = attr.value;
+            refs->idLen = attr.valueLen;
+        }
+        else
+        if (svgScanNameEqual(attr.name, attr.nameLen, "href") || svgScanNameEqual(attr.name, attr.nameLen, "xlink:href")) {
+            refs->href = attr.value;
+            refs->hrefLen = attr.valueLen;
+        }
+    }
+}
+
+// tell if the given char can be part of an element or attribute name
+SVGTboolean svgScanNameChar(const char c) {
+
+    return (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) ||
+            (c == '-') || (c == '_') || (c == ':') || (c == '.')) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// tell if the given name (not null-terminated) is equal to the given string
+SVGTboolean svgScanNameEqual(const char* name,
+                             const size_t nameLen,
+                             const char* str) {
+
+    return ((strlen(str) == nameLen) && (strncmp(name, str, nameLen) == 0)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// get the position just after the given terminator (or the string end, if the terminator is not present)
+const char* svgScanSkipPast(const char* str,
+                            const char* terminator) {
+
+    const char* end = strstr(str, terminator);
+
+    return (end != NULL) ? (end + strlen(terminator)) : (str + strlen(str));
+}
+
+// get the position just after the end of the tag starting at the given position (attribute values are honored)
+const char* svgScanTagEnd(const char* str) {
+
+    char quote = '\0';
+
+    while ((*str != '\0') && ((*str != '>') || (quote != '\0'))) {
+        if (quote != '\0') {
+            quote = (*str == quote) ? '\0' : quote;
+        }
+        else
+        if ((*str == '"') || (*str == '\'')) {
+            quote = *str;
+        }
+        str++;
+    }
+
+    return (*str == '>') ? (str + 1) : str;
+}
+
+// get the position just after the end of the processing instruction or markup declaration starting at the given position
+const char* svgScanDeclarationEnd(const char* str) {
+
+    // a declaration with an internal subset ends with "]>"
+    const char* subset = str;
+
+    while ((*subset != '\0') && (*subset != '>') && (*subset != '[')) {
+        subset++;
+    }
+
+    return (*subset == '[') ? svgScanSkipPast(subset, "]>") : svgScanTagEnd(str);
+}
+
+// initialize the <use> expansion state
+static void scanContextInit(ScanContext* ctx) {
+
+    DYNARRAY_INIT(ctx->elements)
+    DYNARRAY_INIT(ctx->uses)
+    DYNARRAY_INIT(ctx->openElements)
+    arenaInit(&ctx->arena, 4096U);
+    ctx->outOfMemory = (strHashMapInit(&ctx->ids, 64U) == SVGT_NO_ERROR) ? SVGT_FALSE : SVGT_TRUE;
+}
+
+// release the <use> expansion state
+static void scanContextDestroy(ScanContext* ctx) {
+
+    DYNARRAY_DESTROY(ctx->elements)
+    DYNARRAY_DESTROY(ctx->uses)
+    DYNARRAY_DESTROY(ctx->openElements)
+    strHashMapDestroy(&ctx->ids);
+    arenaDestroy(&ctx->arena);
+}
+
+// make a null-terminated copy of the given string within the context arena
+static char* scanKeyClone(ScanContext* ctx,
+                          const char* str,
+                          const size_t len) {
+
+    char* key = arenaAlloc(&ctx->arena, len + 1U);
+
+    if (key != NULL) {
+        (void)memcpy(key, str, len);
+        key[len] = '\0';
+    }
+    else {
+        ctx->outOfMemory = SVGT_TRUE;
+    }
+
+    return key;
+}
+
+// register a start tag
+static void scanElementOpen(ScanContext* ctx,
+                            const SVGTboolean selfClosing,
+                            const SVGTboolean isUse,
+                            const ScanTagRefs* refs) {
+
+    if (!ctx->outOfMemory) {
+
+        const SVGTuint idx = (SVGTuint)ctx->elements.size;
+        // the subtree end of open elements is set when they are closed
+        const ScanElement elem = { idx + 1U, 0U, SCAN_ELEMENT_UNVISITED, 0U, 0U };
+
+        DYNARRAY_PUSH_BACK(ctx->elements, ScanElement, elem)
+        if (ctx->elements.size == idx) {
+            ctx->outOfMemory = SVGT_TRUE;
+        }
+        else {
+            // register the id (if an id is repeated, the first element wins)
+            if ((refs->id != NULL) && (refs->idLen > 0U)) {
+
+                char* key = scanKeyClone(ctx, refs->id, refs->idLen);
+                HashedElementData* value;
+
+                if ((key != NULL) && (!strHashMapGet(&ctx->ids, key, &value))) {
+                    HashedElementData v;
+                    v.u = idx;
+                    if (strHashMapPut(&ctx->ids, key, v) != SVGT_NO_ERROR) {
+                        ctx->outOfMemory = SVGT_TRUE;
+                    }
+                }
+            }
+            // register local references
+            if (isUse && (refs->href != NULL) && (refs->hrefLen > 1U) && (refs->href[0] == '#')) {
+
+                const size_t n = ctx->uses.size;
+                const ScanUse use = { idx, refs->href + 1, refs->hrefLen - 1U, -1 };
+
+                DYNARRAY_PUSH_BACK(ctx->uses, ScanUse, use)
+                if (ctx->uses.size == n) {
+                    ctx->outOfMemory = SVGT_TRUE;
+                }
+            }
+            if (!selfClosing) {
+
+                const size_t n = ctx->openElements.size;
+
+                DYNARRAY_PUSH_BACK(ctx->openElements, SVGTuint, idx)
+                if (ctx->openElements.size == n) {
+                    ctx->outOfMemory = SVGT_TRUE;
+                }
+            }
+        }
+    }
+}
+
+// register a closing tag
+static void scanElementClose(ScanContext* ctx) {
+
+    if ((!ctx->outOfMemory) && (ctx->openElements.size > 0U)) {
+        const SVGTuint idx = ctx->openElements.data[--ctx->openElements.size];
+        ctx->elements.data[idx].end = (SVGTuint)ctx->elements.size;
+    }
+}
+
+// get the index of the first <use> reference that follows the subtree rooted at the given element
+static SVGTuint scanUsesEnd(const ScanContext* ctx,
+                            const ScanElement* elem) {
+
+    return (elem->end < ctx->elements.size) ? ctx->elements.data[elem->end].firstUse : (SVGTuint)ctx->uses.size;
+}
+
+// calculate the number of elements instantiated by <use> references; the expansion of each referenced element is
+// calculated once, and an explicit stack (the open elements one, reused) is used instead of recursion, so that long
+// reference chains cannot overflow the call stack
+static uint64_t scanUseInstances(ScanContext* ctx) {
+
+    size_t i;
+    SVGTuint j = 0U;
+    uint64_t result = 0U;
+    ScanIdxDynArray* stack = &ctx->openElements;
+
+    // elements that are still open (i.e. truncated text) extend to the end
+    for (i = 0U; i < stack->size; ++i) {
+        ctx->elements.data[stack->data[i]].end = (SVGTuint)ctx->elements.size;
+    }
+    stack->size = 0U;
+
+    // the <use> references within the subtree of an element are contiguous
+    for (i = 0U; i < ctx->elements.size; ++i) {
+        while ((j < ctx->uses.size) && (ctx->uses.data[j].elemIdx < i)) {
+            j++;
+        }
+        ctx->elements.data[i].firstUse = j;
+    }
+
+    // resolve references
+    for (i = 0U; (i < ctx->uses.size) && (!ctx->outOfMemory); ++i) {
+
+        ScanUse* use = &ctx->uses.data[i];
+        char* key = scanKeyClone(ctx, use->ref, use->refLen);
+        HashedElementData* value;
+
+        if ((key != NULL) && strHashMapGet(&ctx->ids, key, &value)) {
+            use->target = (SVGTint)value->u;
+        }
+    }
+
+    for (i = 0U; (i < ctx->uses.size) && (!ctx->outOfMemory); ++i) {
+
+        const SVGTint target = ctx->uses.data[i].target;
+
+        if ((target >= 0) && (ctx->elements.data[target].state == SCAN_ELEMENT_UNVISITED)) {
+            DYNARRAY_PUSH_BACK(*stack, SVGTuint, (SVGTuint)target)
+            if (stack->size == 0U) {
+                ctx->outOfMemory = SVGT_TRUE;
+            }
+        }
+        // depth-first expansion
+        while ((stack->size > 0U) && (!ctx->outOfMemory)) {
+
+            const SVGTuint idx = stack->data[stack->size - 1U];
+            ScanElement* elem = &ctx->elements.data[idx];
+
+            if (elem->state == SCAN_ELEMENT_UNVISITED) {
+                elem->state = SCAN_ELEMENT_VISITING;
+                elem->cursor = elem->firstUse;
+                elem->instances = elem->end - idx;
+            }
+
+            if (elem->cursor < scanUsesEnd(ctx, elem)) {
+
+                const SVGTint nested = ctx->uses.data[elem->cursor].target;
+
+                if ((nested >= 0) && (ctx->elements.data[nested].state == SCAN_ELEMENT_UNVISITED)) {
+                    // expand the nested reference first, then come back to it
+                    const size_t n = stack->size;
+                    DYNARRAY_PUSH_BACK(*stack, SVGTuint, (SVGTuint)nested)
+                    if (stack->size == n) {
+                        ctx->outOfMemory = SVGT_TRUE;
+                    }
+                }
+                else {
+                    // unresolved and circular references are not expanded
+                    if ((nested >= 0) && (ctx->elements.data[nested].state == SCAN_ELEMENT_DONE)) {
+                        elem->instances = MIN(elem->instances + ctx->elements.data[nested].instances, (uint64_t)SVG_SCAN_COUNT_MAX);
+                    }
+                    elem->cursor++;
+                }
+            }
+            else {
+                elem->state = SCAN_ELEMENT_DONE;
+                stack->size--;
+            }
+        }
+
+        if ((target >= 0) && (ctx->elements.data[target].state == SCAN_ELEMENT_DONE)) {
+            result = MIN(result + ctx->elements.data[target].instances, (uint64_t)SVG_SCAN_COUNT_MAX);
+        }
+    }
+
+    return result;
+}
+
+// gather complexity statistics from the given null-terminated SVG text
+SVGTErrorCode svgScan(const char* xml,
+                      SvgScanStats* stats) {
+
+    const char* p = xml;
+    // delimiters are searched within known bounds, so that they can be processed in blocks
+    const char* xmlEnd = xml + strlen(xml);
+    SVGTuint depth = 0U;
+    ScanContext ctx;
+    SVGTErrorCode err = SVGT_NO_ERROR;
+
+    (void)memset(stats, 0, sizeof(SvgScanStats));
+    scanContextInit(&ctx);
+
+    while (p < xmlEnd) {
+
+        if (*p != '<') {
+            // text content
+            p = charFind(p, xmlEnd, '<');
+        }
+        else
+        if (strncmp(p, "<!--", 4U) == 0) {
+            const char* end = strstr(p + 4, "-->");
+            err = (end == NULL) ? SVGT_PARSER_ERROR : err;
+            p = (end != NULL) ? (end + 3) : xmlEnd;
+        }
+        else
+        if (strncmp(p, "<![CDATA[", 9U) == 0) {
+            const char* end = strstr(p + 9, "]]>");
+            err = (end == NULL) ? SVGT_PARSER_ERROR : err;
+            p = (end != NULL) ? (end + 3) : xmlEnd;
+        }
+        else
+        if ((p[1] == '?') || (p[1] == '!')) {
+            // processing instructions and document type declarations (with a possible internal subset)
+            p = boundedDeclarationEnd(p, xmlEnd);
+        }
+        else {
+            const char* end = boundedTagEnd(p, xmlEnd);
+
+            if (end[-1] != '>') {
+                // truncated tag
+                err = SVGT_PARSER_ERROR;
+            }
+            else
+            if (p[1] == '/') {
+                // closing tag
+                depth -= (depth > 0U) ? 1U : 0U;
+                scanElementClose(&ctx);
+            }
+            else {
+                const char* name = p + 1;
+                const char* nameEnd = name;
+                const char* localName = name;
+                size_t localNameLen;
+                ScanTagRefs refs = { NULL, 0U, NULL, 0U };
+                const SVGTboolean selfClosing = (end[-2] == '/') ? SVGT_TRUE : SVGT_FALSE;
+
+                while (svgScanNameChar(*nameEnd)) {
+                    // skip namespace prefix
+                    if (*nameEnd == ':') {
+                        localName = nameEnd + 1;
+                    }
+                    nameEnd++;
+                }
+                localNameLen = (size_t)(nameEnd - localName);
+
+                stats->elementsCount++;
+                elementStatsUpdate(stats, localName, localNameLen);
+                attributesScan(stats, nameEnd, end - 1, svgScanNameEqual(localName, localNameLen, "path"),
+                               svgScanNameEqual(localName, localNameLen, "polyline") || svgScanNameEqual(localName, localNameLen, "polygon"), &refs);
+                scanElementOpen(&ctx, selfClosing, svgScanNameEqual(localName, localNameLen, "use"), &refs);
+
+                // self-closing tags do not increase the nesting level
+                depth++;
+                stats->maxDepth = MAX(stats->maxDepth, depth);
+                if (selfClosing) {
+                    depth--;
+                }
+            }
+            p = end;
+        }
+    }
+
+    stats->bytes = (size_t)(p - xml);
+    // expand <use> references
+    if (!ctx.outOfMemory) {
+        stats->useInstancesCount = (SVGTuint)scanUseInstances(&ctx);
+    }
+    if (ctx.outOfMemory) {
+        err = SVGT_OUT_OF_MEMORY_ERROR;
+    }
+
+    scanContextDestroy(&ctx);
+    return err;
+}
+
+// measure units of a length
+typedef enum {
+    SCAN_LENGTH_INVALID = 0,
+    SCAN_LENGTH_ABSOLUTE,
+    SCAN_LENGTH_PERCENTAGE,
+    SCAN_LENGTH_FONT_RELATIVE
+} ScanLengthType;
+
+// skip white spaces, without going past the given end
+static const char* boundedSpacesSkip(const char* p,
+                                     const char* end) {
+
+    while ((p < end) && isSpace(*p)) {
+        p++;
+    }
+
+    return p;
+}
+
+// powers of ten that are exactly representable as double
+static const double scanPow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// parse a number; it returns the given position if no number is present
+static const char* numberParse(const char* p,
+                               const char* end,
+                               SVGTfloat* value) {
+
+    const char* next = numberSkip(p, end);
+
+    if (next > p) {
+
+        const char* q = p;
+        uint64_t mantissa = 0U;
+        SVGTint exponent = 0;
+        SVGTuint digits = 0U;
+        SVGTboolean negative = SVGT_FALSE;
+        SVGTboolean exact = SVGT_TRUE;
+
+        if ((*q == '+') || (*q == '-')) {
+            negative = (*q == '-') ? SVGT_TRUE : SVGT_FALSE;
+            q++;
+        }
+        // significant digits (leading zeros are not counted); up to 19 digits fit a 64bit mantissa
+        while ((q < next) && (*q != '.') && (*q != 'e') && (*q != 'E')) {
+            if ((mantissa != 0U) || (*q != '0')) {
+                if (digits < 19U) {
+                    mantissa = (mantissa * 10U) + (uint64_t)(*q - '0');
+                }
+                else {
+                    exponent++;
+                    exact = SVGT_FALSE;
+                }
+                digits++;
+            }
+            q++;
+        }
+        if ((q < next) && (*q == '.')) {
+            q++;
+            while ((q < next) && (*q != 'e') && (*q != 'E')) {
+                if ((mantissa != 0U) || (*q != '0')) {
+                    if (digits < 19U) {
+                        mantissa = (mantissa * 10U) + (uint64_t)(*q - '0');
+                        exponent--;
+                    }
+                    else {
+                        exact = SVGT_FALSE;
+                    }
+                    digits++;
+                }
+                else {
+                    exponent--;
+                }
+                q++;
+            }
+        }
+        if (q < next) {
+            // exponent (already validated by numberSkip)
+            SVGTint e = 0;
+            SVGTboolean negativeExp = SVGT_FALSE;
+
+            q++;
+            if ((*q == '+') || (*q == '-')) {
+                negativeExp = (*q == '-') ? SVGT_TRUE : SVGT_FALSE;
+                q++;
+            }
+            while (q < next) {
+                // clamp huge exponents, they overflow/underflow anyway
+                e = (e < 100000) ? ((e * 10) + (*q - '0')) : e;
+                q++;
+            }
+            exponent += negativeExp ? -e : e;
+        }
+
+        // fast path: both the mantissa and the power of ten are exact doubles, so a single
+        // multiplication/division gives the correctly rounded result
+        if (exact && (mantissa <= ((uint64_t)1U << 53)) && (exponent >= -22) && (exponent <= 22)) {
+            double d = (double)mantissa;
+            d = (exponent < 0) ? (d / scanPow10[-exponent]) : (d * scanPow10[exponent]);
+            *value = (SVGTfloat)(negative ? -d : d);
+        }
+        else
+        if ((size_t)(next - p) < 64U) {
+            // slow path, left to the C runtime
+            char buffer[64];
+            (void)memcpy(buffer, p, (size_t)(next - p));
+            buffer[next - p] = '\0';
+            *value = (SVGTfloat)strtod(buffer, NULL);
+        }
+        else {
+            next = p;
+        }
+    }
+
+    return next;
+}
+
+// parse a length, converting absolute units to pixels
+static ScanLengthType lengthParse(const char* p,
+                                  const char* end,
+                                  const SVGTfloat dpi,
+                                  SVGTfloat* value) {
+
+    ScanLengthType result = SCAN_LENGTH_INVALID;
+    const char* next = numberParse(boundedSpacesSkip(p, end), end, value);
+
+    if (next > p) {
+
+        const char* unit = boundedSpacesSkip(next, end);
+        const char* unitEnd = unit;
+
+        while ((unitEnd < end) && (!isSpace(*unitEnd))) {
+            unitEnd++;
+        }
+        // nothing but spaces can follow the unit
+        if (boundedSpacesSkip(unitEnd, end) == end) {
+
+            const size_t unitLen = (size_t)(unitEnd - unit);
+
+            result = SCAN_LENGTH_ABSOLUTE;
+            if ((unitLen == 0U) || svgScanNameEqual(unit, unitLen, "px")) {
+                // already in pixels
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "in")) {
+                *value *= dpi;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "cm")) {
+                *value *= dpi / 2.54f;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "mm")) {
+                *value *= dpi / 25.4f;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "pt")) {
+                *value *= dpi / 72.0f;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "pc")) {
+                *value *= dpi / 6.0f;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "%")) {
+                result = SCAN_LENGTH_PERCENTAGE;
+            }
+            else
+            if (svgScanNameEqual(unit, unitLen, "em") || svgScanNameEqual(unit, unitLen, "ex")) {
+                result = SCAN_LENGTH_FONT_RELATIVE;
+            }
+            else {
+                // unknown units make the whole attribute invalid
+                result = SCAN_LENGTH_INVALID;
+            }
+        }
+    }
+
+    return result;
+}
+
+// apply a 'width' or 'height' attribute: intrinsic dimension and initial viewport dimension; only absolute
+// lengths are resolved exactly, the others are estimations (e.g. the font size could be set by a stylesheet)
+static void dimensionApply(const ScanAttribute* attr,
+                           const SVGTfloat dpi,
+                           const SVGTuint screenDimension,
+                           SVGTfloat* dimension,
+                           SVGTfloat* viewportDimension,
+                           SVGTboolean* exact) {
+
+    SVGTfloat v = 0.0f;
+
+    switch (lengthParse(attr->value, attr->value + attr->valueLen, dpi, &v)) {
+        case SCAN_LENGTH_ABSOLUTE:
+            *dimension = v;
+            *viewportDimension = MAX(v, 0.0f);
+            break;
+        case SCAN_LENGTH_PERCENTAGE:
+            *viewportDimension = MAX((SVGTfloat)screenDimension * v / 100.0f, 0.0f);
+            *exact = SVGT_FALSE;
+            break;
+        case SCAN_LENGTH_FONT_RELATIVE:
+            // default font size
+            *viewportDimension = MAX(v * 16.0f, 0.0f);
+            *exact = SVGT_FALSE;
+            break;
+        case SCAN_LENGTH_INVALID:
+        default:
+            *exact = SVGT_FALSE;
+            break;
+    }
+}
+
+// parse a 'viewBox' attribute (four numbers separated by spaces and/or a comma, anything else is ignored)
+static SVGTboolean viewBoxParse(const ScanAttribute* attr,
+                                SVGTfloat* viewBox) {
+
+    SVGTuint i;
+    const char* p = attr->value;
+    const char* end = attr->value + attr->valueLen;
+    SVGTboolean ok = SVGT_TRUE;
+
+    for (i = 0U; (i < 4U) && ok; ++i) {
+
+        const char* next;
+
+        p = boundedSpacesSkip(p, end);
+        if ((i > 0U) && (p < end) && (*p == ',')) {
+            p = boundedSpacesSkip(p + 1, end);
+        }
+        next = numberParse(p, end, &viewBox[i]);
+        ok = (next > p) ? SVGT_TRUE : SVGT_FALSE;
+        p = next;
+    }
+
+    if (ok) {
+        // negative dimensions disable rendering
+        viewBox[2] = MAX(viewBox[2], 0.0f);
+        viewBox[3] = MAX(viewBox[3], 0.0f);
+    }
+
+    return ok;
+}
+
+// parse a 'preserveAspectRatio' attribute: [defer] <align> [meet | slice]
+static void aspectRatioParse(const ScanAttribute* attr,
+                             SVGTAspectRatioAlign* align,
+                             SVGTAspectRatioMeetOrSlice* meetOrSlice) {
+
+    static const char* alignNames[10] = {
+        "none", "xMinYMin", "xMidYMin", "xMaxYMin", "xMinYMid", "xMidYMid", "xMaxYMid", "xMinYMax", "xMidYMax", "xMaxYMax"
+    };
+    const char* end = attr->value + attr->valueLen;
+    const char* p = boundedSpacesSkip(attr->value, end);
+    const char* tokenEnd;
+    SVGTuint i;
+    SVGTboolean alignFound = SVGT_FALSE;
+
+    if (((size_t)(end - p) > 5U) && (memcmp(p, "defer", 5U) == 0) && isSpace(p[5])) {
+        p = boundedSpacesSkip(p + 5, end);
+    }
+
+    tokenEnd = p;
+    while ((tokenEnd < end) && (!isSpace(*tokenEnd))) {
+        tokenEnd++;
+    }
+    for (i = 0U; i < 10U; ++i) {
+        if (svgScanNameEqual(p, (size_t)(tokenEnd - p), alignNames[i])) {
+            *align = (SVGTAspectRatioAlign)i;
+            alignFound = SVGT_TRUE;
+        }
+    }
+
+    // an invalid alignment makes the whole attribute invalid
+    if (alignFound) {
+        p = boundedSpacesSkip(tokenEnd, end);
+        tokenEnd = p;
+        while ((tokenEnd < end) && (!isSpace(*tokenEnd))) {
+            tokenEnd++;
+        }
+        if (svgScanNameEqual(p, (size_t)(tokenEnd - p), "slice")) {
+            *meetOrSlice = SVGT_ASPECT_RATIO_SLICE;
+        }
+    }
+}
+
+// get information about the outermost <svg> element of the given SVG text
+SVGTErrorCode svgScanProbe(const char* xml,
+                           const size_t length,
+                           const SVGTfloat dpi,
+                           const SVGTuint screenWidth,
+                           const SVGTuint screenHeight,
+                           SvgDocInfo* info) {
+
+    const char* p = xml;
+    const char* end = xml + length;
+    SVGTErrorCode err = SVGT_PARSER_ERROR;
+
+    info->width = -1.0f;
+    info->height = -1.0f;
+    info->hasViewBox = SVGT_FALSE;
+    info->viewport[0] = 0.0f;
+    info->viewport[1] = 0.0f;
+    info->viewport[2] = (SVGTfloat)screenWidth;
+    info->viewport[3] = (SVGTfloat)screenHeight;
+    info->align = SVGT_ASPECT_RATIO_ALIGN_XMIDYMID;
+    info->meetOrSlice = SVGT_ASPECT_RATIO_MEET;
+    info->exact = SVGT_TRUE;
+
+    // skip UTF-8 BOM
+    if ((length >= 3U) && ((SVGTubyte)p[0] == 0xEFU) && ((SVGTubyte)p[1] == 0xBBU) && ((SVGTubyte)p[2] == 0xBFU)) {
+        p += 3;
+    }
+
+    // skip XML declaration, processing instructions, comments and document type declaration
+    while ((p < end) && (err == SVGT_PARSER_ERROR)) {
+
+        if (*p != '<') {
+            p++;
+        }
+        else
+        if (((size_t)(end - p) >= 4U) && (memcmp(p, "<!--", 4U) == 0)) {
+            p = boundedSkipPast(p + 4, end, "-->");
+        }
+        else
+        if (((size_t)(end - p) >= 2U) && ((p[1] == '?') || (p[1] == '!'))) {
+            p = boundedDeclarationEnd(p, end);
+        }
+        else {
+            // the outermost element
+            const char* tagEnd = boundedTagEnd(p, end);
+            const char* name = p + 1;
+            const char* nameEnd = name;
+            const char* localName = name;
+
+            while ((nameEnd < tagEnd) && svgScanNameChar(*nameEnd)) {
+                // skip namespace prefix
+                if (*nameEnd == ':') {
+                    localName = nameEnd + 1;
+                }
+                nameEnd++;
+            }
+
+            if ((tagEnd[-1] == '>') && svgScanNameEqual(localName, (size_t)(nameEnd - localName), "svg")) {
+
+                ScanAttribute attr;
+                const char* q = nameEnd;
+                SVGTfloat viewBox[4];
+
+                while (attributeNext(&q, tagEnd - 1, &attr)) {
+
+                    if (svgScanNameEqual(attr.name, attr.nameLen, "width")) {
+                        dimensionApply(&attr, dpi, screenWidth, &info->width, &info->viewport[2], &info->exact);
+                    }
+                    else
+                    if (svgScanNameEqual(attr.name, attr.nameLen, "height")) {
+                        dimensionApply(&attr, dpi, screenHeight, &info->height, &info->viewport[3], &info->exact);
+                    }
+                    else
+                    if (svgScanNameEqual(attr.name, attr.nameLen, "viewBox")) {
+                        info->hasViewBox = viewBoxParse(&attr, viewBox);
+                    }
+                    else
+                    if (svgScanNameEqual(attr.name, attr.nameLen, "preserveAspectRatio")) {
+                        aspectRatioParse(&attr, &info->align, &info->meetOrSlice);
+                    }
+                    else
+                    if (svgScanNameEqual(attr.name, attr.nameLen, "style")) {
+                        // CSS properties (e.g. width and height) override presentation attributes
+                        info->exact = SVGT_FALSE;
+                    }
+                }
+
+                // the 'viewBox' attribute takes precedence over dimensions (the intrinsic ones are still
+                // reported, so an estimated dimension keeps the whole information inexact)
+                if (info->hasViewBox) {
+                    (void)memcpy(info->viewport, viewBox, sizeof(viewBox));
+                }
+                err = SVGT_NO_ERROR;
+            }
+            // stop at the first element, in any case
+            p = end;
+        }
+    }
+
+    return err;
+}
+
+// check the given statistics against the given limits
+SvgScanLimit svgScanLimitsCheck(const SvgScanStats* stats,
+                                const SvgScanLimits* limits,
+                                const SVGTuint surfaceWidth,
+                                const SVGTuint surfaceHeight,
+                                uint64_t* value,
+                                SVGTuint* maxValue) {
+
+    SvgScanLimit result = SVG_SCAN_LIMIT_NONE;
+    const uint64_t filterPixels = (uint64_t)stats->filterPrimitivesCount * surfaceWidth * surfaceHeight;
+
+    if ((limits->maxElements > 0U) && (stats->elementsCount > limits->maxElements)) {
+        result = SVG_SCAN_LIMIT_ELEMENTS;
+        *value = stats->elementsCount;
+        *maxValue = limits->maxElements;
+    }
+    else
+    if ((limits->maxUseInstances > 0U) && (stats->useInstancesCount > limits->maxUseInstances)) {
+        result = SVG_SCAN_LIMIT_USE_INSTANCES;
+        *value = stats->useInstancesCount;
+        *maxValue = limits->maxUseInstances;
+    }
+    else
+    if ((limits->maxPathSegments > 0U) && (stats->pathSegmentsCount > limits->maxPathSegments)) {
+        result = SVG_SCAN_LIMIT_PATH_SEGMENTS;
+        *value = stats->pathSegmentsCount;
+        *maxValue = limits->maxPathSegments;
+    }
+    else
+    if ((limits->maxDepth > 0U) && (stats->maxDepth > limits->maxDepth)) {
+        result = SVG_SCAN_LIMIT_DEPTH;
+        *value = stats->maxDepth;
+        *maxValue = limits->maxDepth;
+    }
+    else
+    if ((limits->maxFilterPixels > 0U) && (filterPixels > limits->maxFilterPixels)) {
+        result = SVG_SCAN_LIMIT_FILTER_PIXELS;
+        *value = filterPixels;
+        *maxValue = limits->maxFilterPixels;
+    }
+
+    return result;
+}
+
+// get the (printable) name of the given limit
+const char* svgScanLimitName(const SvgScanLimit limit) {
+
+    const char* name;
+
+    switch (limit) {
+        case SVG_SCAN_LIMIT_ELEMENTS:
+            name = "elements";
+            break;
+        case SVG_SCAN_LIMIT_USE_INSTANCES:
+            name = "<use> instances";
+            break;
+        case SVG_SCAN_LIMIT_PATH_SEGMENTS:
+            name = "path segments";
+            break;
+        case SVG_SCAN_LIMIT_DEPTH:
+            name = "nesting depth";
+            break;
+        case SVG_SCAN_LIMIT_FILTER_PIXELS:
+            name = "filter pixels";
+            break;
+        case SVG_SCAN_LIMIT_NONE:
+        default:
+            name = "none";
+            break;
+    }
+
+    return name;
+}
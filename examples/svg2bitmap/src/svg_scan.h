@@ -0,0 +1,182 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef SVG_SCAN_H
+#define SVG_SCAN_H
+
+/*!
+    \file svg_scan.h
+    \brief Lightweight scanning of SVG text, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include <SVGT/svgt.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// complexity statistics of an SVG document, gathered from its text (i.e. without parsing it)
+typedef struct {
+    // size of the text, in bytes
+    size_t bytes;
+    // total number of elements and attributes
+    SVGTuint elementsCount;
+    SVGTuint attributesCount;
+    // maximum elements nesting depth (the outermost element has depth 1)
+    SVGTuint maxDepth;
+    // maximum length of an attribute value, in bytes
+    size_t maxAttributeLength;
+    // container elements: <g>, <svg>, <a>, <switch>, <symbol>, <defs>
+    SVGTuint groupsCount;
+    // basic shapes: <path>, <rect>, <circle>, <ellipse>, <line>, <polyline>, <polygon>
+    SVGTuint shapesCount;
+    // <path> elements and their segments (an implicit command repetition counts as a segment); the segments
+    // of <polyline> and <polygon> elements (a segment for each point) are counted too
+    SVGTuint pathsCount;
+    SVGTuint pathSegmentsCount;
+    // text runs: <text>, <tspan>, <textPath>
+    SVGTuint textRunsCount;
+    // <image> and <use> elements
+    SVGTuint imagesCount;
+    SVGTuint usesCount;
+    // elements instantiated by <use> references (nested references are expanded, circular ones are not)
+    SVGTuint useInstancesCount;
+    // paint servers and clipping
+    SVGTuint gradientsCount;
+    SVGTuint patternsCount;
+    SVGTuint masksCount;
+    SVGTuint clipPathsCount;
+    // <filter> elements and their primitives (<fe...> elements, excluding light sources and transfer functions)
+    SVGTuint filtersCount;
+    SVGTuint filterPrimitivesCount;
+    // <style> elements
+    SVGTuint stylesCount;
+} SvgScanStats;
+
+// limits on the complexity of untrusted documents (0 means no limit)
+typedef struct {
+    SVGTuint maxElements;
+    SVGTuint maxUseInstances;
+    SVGTuint maxPathSegments;
+    SVGTuint maxDepth;
+    // filter primitives are assumed to cover the whole drawing surface, so this limit
+    // applies to the number of filter primitives multiplied by the surface pixels
+    SVGTuint maxFilterPixels;
+} SvgScanLimits;
+
+// the limit exceeded by a document
+typedef enum {
+    SVG_SCAN_LIMIT_NONE = 0,
+    SVG_SCAN_LIMIT_ELEMENTS,
+    SVG_SCAN_LIMIT_USE_INSTANCES,
+    SVG_SCAN_LIMIT_PATH_SEGMENTS,
+    SVG_SCAN_LIMIT_DEPTH,
+    SVG_SCAN_LIMIT_FILTER_PIXELS
+} SvgScanLimit;
+
+// information about the outermost <svg> element, gathered without parsing the whole document
+typedef struct {
+    // intrinsic dimensions, in pixels; a negative value is reported if the attribute is missing or it is expressed
+    // in relative units (i.e. the same values returned by svgtDocWidth and svgtDocHeight)
+    SVGTfloat width;
+    SVGTfloat height;
+    // SVGT_TRUE if a valid 'viewBox' attribute is present
+    SVGTboolean hasViewBox;
+    // initial document viewport (i.e. the same value returned by svgtDocViewportGet): the 'viewBox' attribute if
+    // present, else the result of 'width' and 'height' attributes (the screen dimensions are used for missing ones)
+    SVGTfloat viewport[4];
+    // 'preserveAspectRatio' attribute (xMidYMid meet if not present)
+    SVGTAspectRatioAlign align;
+    SVGTAspectRatioMeetOrSlice meetOrSlice;
+    // SVGT_FALSE if dimensions are not expressed in absolute units (i.e. percentages, em, ex, invalid values) or the
+    // element has a 'style' attribute, so that they cannot be resolved for sure without parsing the document; in this
+    // case dimensions and viewport must be considered an estimation
+    SVGTboolean exact;
+} SvgDocInfo;
+
+// error code used when a document exceeds one of the given limits
+#define SVG_SCAN_LIMIT_ERROR ((SVGTErrorCode)1001)
+
+// tell if the given char can be part of an element or attribute name
+SVGTboolean svgScanNameChar(const char c);
+
+// tell if the given name (not null-terminated) is equal to the given string
+SVGTboolean svgScanNameEqual(const char* name,
+                             const size_t nameLen,
+                             const char* str);
+
+// get the position just after the given terminator (or the string end, if the terminator is not present)
+const char* svgScanSkipPast(const char* str,
+                            const char* terminator);
+
+// get the position just after the end of the tag starting at the given position (attribute values are honored)
+const char* svgScanTagEnd(const char* str);
+
+// get the position just after the end of the processing instruction or markup declaration (e.g. <!DOCTYPE>, with a
+// possible internal subset) starting at the given position; comments and CDATA sections must be handled by the caller
+const char* svgScanDeclarationEnd(const char* str);
+
+// gather complexity statistics from the given null-terminated SVG text; SVGT_PARSER_ERROR is returned if the
+// text is truncated (i.e. unterminated tags, comments or CDATA sections), but statistics are filled anyway;
+// SVGT_OUT_OF_MEMORY_ERROR is returned if <use> references could not be expanded
+SVGTErrorCode svgScan(const char* xml,
+                      SvgScanStats* stats);
+
+// get information about the outermost <svg> element of the given SVG text (not necessarily null-terminated), scanning
+// that element only; lengths are converted using the given dpi, relative ones refer to the given screen dimensions;
+// SVGT_PARSER_ERROR is returned if the outermost element is not a (complete) <svg> element
+SVGTErrorCode svgScanProbe(const char* xml,
+                           const size_t length,
+                           const SVGTfloat dpi,
+                           const SVGTuint screenWidth,
+                           const SVGTuint screenHeight,
+                           SvgDocInfo* info);
+
+// check the given statistics against the given limits; the first exceeded limit is returned, along with the
+// measured value and the limit value; the filter pixels limit is checked only if the drawing surface dimensions are not zero
+SvgScanLimit svgScanLimitsCheck(const SvgScanStats* stats,
+                                const SvgScanLimits* limits,
+                                const SVGTuint surfaceWidth,
+                                const SVGTuint surfaceHeight,
+                                uint64_t* value,
+                                SVGTuint* maxValue);
+
+// get the (printable) name of the given limit
+const char* svgScanLimitName(const SvgScanLimit limit);
+
+#endif /* SVG_SCAN_H */
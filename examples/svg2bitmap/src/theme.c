@@ -0,0 +1,418 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+/*!
+    \file theme.c
+    \brief Style overrides (theming) applied to SVG text, implementation.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "theme.h"
+#include "str_utils.h"
+
+// a single override, pointing inside the overrides string
+typedef struct {
+    const char* key;
+    size_t keyLen;
+    const char* value;
+    size_t valueLen;
+} ThemeOverride;
+
+// the parsed list of overrides
+typedef struct {
+    ThemeOverride overrides[THEME_MAX_OVERRIDES];
+    SVGTuint count;
+} ThemeTable;
+
+// scanner states
+typedef enum {
+    // text content
+    THEME_SCAN_TEXT  = 0,
+    // inside a tag, outside attribute values
+    THEME_SCAN_TAG   = 1,
+    // inside an attribute value
+    THEME_SCAN_VALUE = 2,
+    // inside a <style> element
+    THEME_SCAN_STYLE = 3
+} ThemeScanState;
+
+// tell if the given char can be part of a color keyword, an hexadecimal color or a custom property name
+static SVGTboolean isTokenChar(const char c) {
+
+    return (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) ||
+            (c == '-') || (c == '_') || (c == '#')) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// case insensitive comparison of the given number of chars
+static SVGTboolean strNCaseEqual(const char* s1,
+                                 const char* s2,
+                                 const size_t n) {
+
+    size_t i = 0U;
+
+    while ((i < n) && (upperChar(s1[i]) == upperChar(s2[i]))) {
+        i++;
+    }
+
+    return (i == n) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// remove trailing spaces
+static size_t trimRight(const char* str,
+                        size_t len) {
+
+    while ((len > 0U) && isSpace(str[len - 1U])) {
+        len--;
+    }
+
+    return len;
+}
+
+// tell if the value of the attribute, whose name ends just before the given position (optional spaces and '=' included),
+// must be left untouched (i.e. identifiers and references, that could match color keywords by chance)
+static SVGTboolean rawValueAttribute(const char* tagStart,
+                                     const char* p) {
+
+    static const char* rawAttributes[4] = { "id", "class", "href", "xlink:href" };
+    const char* nameEnd = p;
+    const char* nameStart;
+    SVGTboolean raw = SVGT_FALSE;
+
+    while ((nameEnd > tagStart) && (isSpace(nameEnd[-1]) || (nameEnd[-1] == '='))) {
+        nameEnd--;
+    }
+    nameStart = nameEnd;
+    while ((nameStart > tagStart) && (isTokenChar(nameStart[-1]) || (nameStart[-1] == ':'))) {
+        nameStart--;
+    }
+
+    for (SVGTuint i = 0U; (i < 4U) && (!raw); ++i) {
+        const size_t len = strlen(rawAttributes[i]);
+        raw = (((size_t)(nameEnd - nameStart) == len) && (strncmp(nameStart, rawAttributes[i], len) == 0)) ? SVGT_TRUE : SVGT_FALSE;
+    }
+
+    return raw;
+}
+
+// parse the overrides string, in the format "key=value,key=value,..."
+static SVGTboolean themeTableParse(const char* overrides,
+                                   ThemeTable* table) {
+
+    SVGTboolean ok = SVGT_TRUE;
+    const char* s = overrides;
+    size_t len = strlen(overrides);
+
+    table->count = 0U;
+
+    while ((*s != '\0') && ok) {
+
+        const char* keyStart = skipSpaces(s, &len);
+        const char* itemEnd = skipUntilChar(keyStart, &len, ',');
+        const char* eq = keyStart;
+
+        // look for the '=' separator
+        while ((eq < itemEnd) && (*eq != '=')) {
+            eq++;
+        }
+
+        if ((eq < itemEnd) && (table->count < THEME_MAX_OVERRIDES)) {
+
+            ThemeOverride* ovr = &table->overrides[table->count];
+            size_t valueLen = (size_t)(itemEnd - (eq + 1));
+
+            ovr->key = keyStart;
+            ovr->keyLen = trimRight(keyStart, (size_t)(eq - keyStart));
+            ovr->value = skipSpaces(eq + 1, &valueLen);
+            ovr->valueLen = trimRight(ovr->value, valueLen);
+            ok = ((ovr->keyLen > 0U) && (ovr->valueLen > 0U)) ? SVGT_TRUE : SVGT_FALSE;
+            table->count++;
+        }
+        else {
+            // missing separator, or too many overrides
+            ok = SVGT_FALSE;
+        }
+
+        // skip comma
+        if (*itemEnd == ',') {
+            itemEnd++;
+            len--;
+        }
+        s = itemEnd;
+    }
+
+    return ok;
+}
+
+// find the override matching the given token
+static const ThemeOverride* themeTableFind(const ThemeTable* table,
+                                           const char* token,
+                                           const size_t tokenLen) {
+
+    const ThemeOverride* result = NULL;
+
+    for (SVGTuint i = 0U; (i < table->count) && (result == NULL); ++i) {
+
+        const ThemeOverride* ovr = &table->overrides[i];
+
+        if ((ovr->keyLen == tokenLen) && strNCaseEqual(ovr->key, token, tokenLen)) {
+            result = ovr;
+        }
+    }
+
+    return result;
+}
+
+// try to resolve a 'var(--name[, fallback])' reference; it returns the number of consumed chars (0 if the reference
+// cannot be resolved), and sets 'replacement' accordingly
+static size_t varResolve(const ThemeTable* table,
+                         const char* str,
+                         const char** replacement,
+                         size_t* replacementLen) {
+
+    size_t consumed = 0U;
+    // skip "var("
+    const char* nameStart = str + 4;
+    const char* nameEnd;
+    const char* p;
+    const char* fallback = NULL;
+    SVGTint depth = 1;
+
+    while (isSpace(*nameStart)) {
+        nameStart++;
+    }
+    nameEnd = nameStart;
+    while (isTokenChar(*nameEnd)) {
+        nameEnd++;
+    }
+    p = nameEnd;
+    while (isSpace(*p)) {
+        p++;
+    }
+    if (*p == ',') {
+        p++;
+        while (isSpace(*p)) {
+            p++;
+        }
+        fallback = p;
+    }
+
+    // find the matching closing parenthesis, without crossing attribute values or tags
+    while ((*p != '\0') && (*p != '"') && (*p != '\'') && (*p != '<') && (depth > 0)) {
+        depth += (*p == '(') ? 1 : ((*p == ')') ? -1 : 0);
+        p++;
+    }
+
+    if (depth == 0) {
+
+        const ThemeOverride* ovr = themeTableFind(table, nameStart, (size_t)(nameEnd - nameStart));
+
+        if (ovr != NULL) {
+            *replacement = ovr->value;
+            *replacementLen = ovr->valueLen;
+            consumed = (size_t)(p - str);
+        }
+        else
+        if (fallback != NULL) {
+            // 'p' is just after the closing parenthesis
+            *replacement = fallback;
+            *replacementLen = trimRight(fallback, (size_t)((p - 1) - fallback));
+            consumed = (size_t)(p - str);
+        }
+    }
+
+    return consumed;
+}
+
+// check the syntax of the given list of overrides
+SVGTboolean themeOverridesValid(const char* overrides) {
+
+    ThemeTable table;
+
+    return ((overrides != NULL) && themeTableParse(overrides, &table)) ? SVGT_TRUE : SVGT_FALSE;
+}
+
+// apply the given list of overrides to the SVG text
+SVGTErrorCode themeApply(const char* xml,
+                         const char* overrides,
+                         char** result,
+                         SVGTuint* substitutions) {
+
+    SVGTErrorCode err = SVGT_NO_ERROR;
+    ThemeTable table;
+    StrBuffer buffer = { NULL, 0U, 0U };
+    ThemeScanState state = THEME_SCAN_TEXT;
+    SVGTboolean styleTag = SVGT_FALSE;
+    SVGTboolean rawValue = SVGT_FALSE;
+    const char* tagStart = xml;
+    char quote = '"';
+    const char* p = xml;
+
+    *result = NULL;
+    *substitutions = 0U;
+
+    if (!themeTableParse(overrides, &table)) {
+        err = SVGT_ILLEGAL_ARGUMENT_ERROR;
+    }
+    else {
+        // substitutions do not usually change the text length that much
+        buffer.capacity = strlen(xml) + (strlen(xml) / 8U) + 1U;
+        if ((buffer.data = memMalloc(buffer.capacity)) != NULL) {
+            buffer.data[0] = '\0';
+        }
+        else {
+            err = SVGT_OUT_OF_MEMORY_ERROR;
+        }
+    }
+
+    while ((*p != '\0') && (err == SVGT_NO_ERROR)) {
+
+        // number of source chars to copy verbatim
+        size_t copyLen = 1U;
+        const char* replacement = NULL;
+        size_t replacementLen = 0U;
+        size_t consumed = 0U;
+
+        switch (state) {
+
+            case THEME_SCAN_TEXT:
+                if (strncmp(p, "<!--", 4U) == 0) {
+                    // copy the whole comment
+                    const char* end = strstr(p + 4, "-->");
+                    copyLen = (end != NULL) ? (size_t)((end + 3) - p) : strlen(p);
+                }
+                else
+                if (strncmp(p, "<![CDATA[", 9U) == 0) {
+                    // copy the whole CDATA section
+                    const char* end = strstr(p + 9, "]]>");
+                    copyLen = (end != NULL) ? (size_t)((end + 3) - p) : strlen(p);
+                }
+                else
+                if (*p == '<') {
+                    // opening <style> elements switch to CSS content, once the tag is closed
+                    styleTag = (strNCaseEqual(p + 1, "style", 5U) && (!isTokenChar(p[6]))) ? SVGT_TRUE : SVGT_FALSE;
+                    tagStart = p;
+                    state = THEME_SCAN_TAG;
+                }
+                break;
+
+            case THEME_SCAN_TAG:
+                if ((*p == '"') || (*p == '\'')) {
+                    quote = *p;
+                    rawValue = rawValueAttribute(tagStart, p);
+                    state = THEME_SCAN_VALUE;
+                }
+                else
+                if (*p == '>') {
+                    state = (styleTag && (p[-1] != '/')) ? THEME_SCAN_STYLE : THEME_SCAN_TEXT;
+                }
+                break;
+
+            case THEME_SCAN_VALUE:
+            case THEME_SCAN_STYLE:
+            default:
+                if ((state == THEME_SCAN_VALUE) && (*p == quote)) {
+                    state = THEME_SCAN_TAG;
+                }
+                else
+                if ((state == THEME_SCAN_STYLE) && (strncmp(p, "</", 2U) == 0) && strNCaseEqual(p + 2, "style", 5U)) {
+                    styleTag = SVGT_FALSE;
+                    tagStart = p;
+                    state = THEME_SCAN_TAG;
+                }
+                else
+                if ((state == THEME_SCAN_VALUE) && rawValue) {
+                    // copy the whole value at once
+                    const char* end = strchr(p, quote);
+                    copyLen = (end != NULL) ? (size_t)(end - p) : strlen(p);
+                }
+                else
+                if (isTokenChar(*p) && (!isTokenChar(p[-1]))) {
+
+                    const char* tokenEnd = p;
+
+                    while (isTokenChar(*tokenEnd)) {
+                        tokenEnd++;
+                    }
+
+                    if (((tokenEnd - p) == 3) && strNCaseEqual(p, "var", 3U) && (*tokenEnd == '(')) {
+                        consumed = varResolve(&table, p, &replacement, &replacementLen);
+                    }
+                    else {
+                        const ThemeOverride* ovr = themeTableFind(&table, p, (size_t)(tokenEnd - p));
+
+                        if (ovr != NULL) {
+                            replacement = ovr->value;
+                            replacementLen = ovr->valueLen;
+                            consumed = (size_t)(tokenEnd - p);
+                        }
+                    }
+                    // copy unmatched tokens at once
+                    copyLen = (size_t)(tokenEnd - p);
+                }
+                break;
+        }
+
+        if (consumed > 0U) {
+            if (strBufferAppend(&buffer, replacement, replacementLen)) {
+                (*substitutions)++;
+                p += consumed;
+            }
+            else {
+                err = SVGT_OUT_OF_MEMORY_ERROR;
+            }
+        }
+        else {
+            if (strBufferAppend(&buffer, p, copyLen)) {
+                p += copyLen;
+            }
+            else {
+                err = SVGT_OUT_OF_MEMORY_ERROR;
+            }
+        }
+    }
+
+    if (err == SVGT_NO_ERROR) {
+        *result = buffer.data;
+    }
+    else {
+        memFree(buffer.data);
+    }
+
+    return err;
+}
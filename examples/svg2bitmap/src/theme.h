@@ -0,0 +1,70 @@
+/****************************************************************************
+** Copyright (c) 2013-2023 Mazatech S.r.l.
+** All rights reserved.
+**
+** This file is part of AmanithSVG software, an SVG rendering library.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted (subject to the limitations in the disclaimer
+** below) provided that the following conditions are met:
+**
+** - Redistributions of source code must retain the above copyright notice,
+**   this list of conditions and the following disclaimer.
+**
+** - Redistributions in binary form must reproduce the above copyright notice,
+**   this list of conditions and the following disclaimer in the documentation
+**   and/or other materials provided with the distribution.
+**
+** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+**   may be used to endorse or promote products derived from this software
+**   without specific prior written permission.
+**
+** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** For any information, please contact info@mazatech.com
+**
+****************************************************************************/
+
+#ifndef THEME_H
+#define THEME_H
+
+/*!
+    \file theme.h
+    \brief Style overrides (theming) applied to SVG text, header.
+    \author Matteo Muratori
+    \author Michele Fabbri
+*/
+
+#include "config.h"
+
+// maximum number of overrides within a single theme
+#define THEME_MAX_OVERRIDES 64U
+
+// check the syntax of the given list of overrides, in the format "key=value,key=value,..."
+SVGTboolean themeOverridesValid(const char* overrides);
+
+// apply the given list of overrides to the SVG text, in the format "key=value,key=value,..."; each key can be:
+// - a color keyword or an hexadecimal color (e.g. 'red', '#FF0000'), matched case-insensitively
+// - 'currentColor', so that the whole document can be tinted at once
+// - a CSS custom property (e.g. '--accent'), that replaces each 'var(--accent[, fallback])' reference
+// keys are replaced within attribute values and <style> elements only, never within text content; unresolved
+// 'var()' references that specify a fallback value are replaced by the fallback itself
+// the result is a new (null-terminated) buffer that must be released by the caller, 'substitutions' is the
+// number of replaced tokens
+SVGTErrorCode themeApply(const char* xml,
+                         const char* overrides,
+                         char** result,
+                         SVGTuint* substitutions);
+
+#endif /* THEME_H */
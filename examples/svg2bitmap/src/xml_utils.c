@@ -53,7 +53,7 @@ static char* xml_strcat(char* dst,
 
 	const size_t l = (dst != NULL) ? strlen(dst) : 0U;
 	const size_t s = strlen(src);
-	char* new_dst = realloc(dst, l + s + 1U);
+	char* new_dst = memRealloc(dst, l + s + 1U);
 
 	if (new_dst != NULL) {
 		dst = new_dst;
@@ -85,11 +85,11 @@ static void xml_child_serialize(char** data,
 	// serialize attributes
 	if (n->attrs.count > 0) {
 		for (i = 0; i < n->attrs.count; ++i) {
-			char* s = malloc(strlen(n->attrs.names[i]) + strlen(n->attrs.values[i]) + 5);
+			char* s = memMalloc(strlen(n->attrs.names[i]) + strlen(n->attrs.values[i]) + 5);
 			if (s != NULL) {
 				(void)sprintf(s, " %s=\"%s\"", n->attrs.names[i], n->attrs.values[i]);
 				*data = xml_strcat(*data, s);
-				free(s);
+				memFree(s);
 			}
 		}
 	}
@@ -117,10 +117,10 @@ static void xml_child_serialize(char** data,
 		}
 
 		// close the tag
-		if ((s = malloc(strlen(n->name) + 6)) != NULL) {
+		if ((s = memMalloc(strlen(n->name) + 6)) != NULL) {
 			(void)sprintf(s, "</%s>\n", n->name);
 			*data = xml_strcat(*data, s);
-			free(s);
+			memFree(s);
 		}
 
 	}
@@ -133,7 +133,7 @@ static void xml_child_serialize(char** data,
 // create an XML document for serialization
 xml_doc xml_doc_create() {
 	
-	xml_doc doc = { .root = malloc(sizeof(xml_node)) };
+	xml_doc doc = { .root = memMalloc(sizeof(xml_node)) };
 
 	if (doc.root != NULL) {
 		doc.root->name = NULL;
@@ -173,22 +173,22 @@ static void xml_node_free(xml_node* node) {
 	}
 
 	if (node->childs != NULL) {
-		free(node->childs);
+		memFree(node->childs);
 	}
 
 	// free attributes
 	if (node->attrs.count > 0) {
 		for (i = 0; i < node->attrs.count; ++i) {
-			free(node->attrs.names[i]);
-			free(node->attrs.values[i]);
+			memFree(node->attrs.names[i]);
+			memFree(node->attrs.values[i]);
 		}
-		free(node->attrs.names);
-		free(node->attrs.values);
+		memFree(node->attrs.names);
+		memFree(node->attrs.values);
 	}
 
-	free(node->name);
+	memFree(node->name);
 	if (node->content != NULL) {
-		free(node->content);
+		memFree(node->content);
 	}
 }
 
@@ -197,7 +197,7 @@ void xml_doc_free(xml_doc* doc) {
 
 	// free nodes starting from root
 	xml_node_free(doc->root);
-	free(doc->root);
+	memFree(doc->root);
 }
 
 // add a node to the given parent
@@ -208,10 +208,10 @@ xml_node* xml_node_add(xml_node* parent,
 	xml_node* n = NULL;
 
 	if (parent != NULL) {
-		xml_node* new_childs = realloc(parent->childs, (parent->child_count + 1) * sizeof(xml_node));
+		xml_node* new_childs = memRealloc(parent->childs, (parent->child_count + 1) * sizeof(xml_node));
 
-		char* actualName = calloc(strlen(name) + 1, sizeof(char));
-		char* actualContent = (content != NULL) ? calloc(strlen(content) + 1, sizeof(char)) : NULL;
+		char* actualName = memCalloc(strlen(name) + 1, sizeof(char));
+		char* actualContent = (content != NULL) ? memCalloc(strlen(content) + 1, sizeof(char)) : NULL;
 
 		if ((new_childs != NULL) && (actualName != NULL)) {
 
@@ -240,13 +240,13 @@ void xml_attr_str_add(xml_node* node,
 					  const char* name,
 				      const char* value) {
 
-	char** new_names = realloc(node->attrs.names, (node->attrs.count + 1) * sizeof(char**));
-	char** new_values = realloc(node->attrs.values, (node->attrs.count + 1) * sizeof(char**));
+	char** new_names = memRealloc(node->attrs.names, (node->attrs.count + 1) * sizeof(char**));
+	char** new_values = memRealloc(node->attrs.values, (node->attrs.count + 1) * sizeof(char**));
 
 	if ((new_names != NULL) && (new_values != NULL)) {
 
-		char* actualName = calloc(strlen(name) + 1, sizeof(char));
-		char* actualValue = calloc(strlen(value) + 1, sizeof(char));
+		char* actualName = memCalloc(strlen(name) + 1, sizeof(char));
+		char* actualValue = memCalloc(strlen(value) + 1, sizeof(char));
 
 		if ((actualName != NULL) && (actualValue != NULL)) {
 			// copy name and value
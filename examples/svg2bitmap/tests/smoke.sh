@@ -0,0 +1,272 @@
+#!/bin/sh
+#/****************************************************************************
+#** Copyright (c) 2013-2023 Mazatech S.r.l.
+#** All rights reserved.
+#**
+#** This file is part of AmanithSVG software, an SVG rendering library.
+#**
+#** Redistribution and use in source and binary forms, with or without
+#** modification, are permitted (subject to the limitations in the disclaimer
+#** below) provided that the following conditions are met:
+#**
+#** - Redistributions of source code must retain the above copyright notice,
+#**   this list of conditions and the following disclaimer.
+#**
+#** - Redistributions in binary form must reproduce the above copyright notice,
+#**   this list of conditions and the following disclaimer in the documentation
+#**   and/or other materials provided with the distribution.
+#**
+#** - Neither the name of Mazatech S.r.l. nor the names of its contributors
+#**   may be used to endorse or promote products derived from this software
+#**   without specific prior written permission.
+#**
+#** NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+#** BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+#** CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+#** NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+#** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+#** OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+#** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+#** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+#** OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+#** WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+#** OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+#** ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#**
+#** For any information, please contact info@mazatech.com
+#**
+#****************************************************************************/
+#
+# svg2bitmap smoke test.
+#
+# Usage: smoke.sh [--update] [<svg2bitmap executable>]
+#
+# Each case renders one of the fixtures (tests/fixtures) and the produced files, together with the deterministic
+# part of the printed report (timings excluded), are compared against tests/baseline.txt in the form:
+#
+#   <case> <file> <size in bytes> <sha256>
+#
+# PNG files are compared byte by byte, so the baseline is bound to the bundled AmanithSVG library and to the
+# embedded PNG encoder; it has been generated on Linux x86_64. After an intended change in the output, run the
+# script with --update and review the baseline diff.
+#
+# The executable defaults to the one built by CMake (bin/<platform>/<arch>/sre/standalone/svg2bitmap).
+
+TESTS_DIR=$(cd "$(dirname "$0")" && pwd)
+FIXTURES_DIR="$TESTS_DIR/fixtures"
+BASELINE="$TESTS_DIR/baseline.txt"
+UPDATE=0
+
+if [ "$1" = "--update" ]; then
+    UPDATE=1
+    shift
+fi
+
+if [ -n "$1" ]; then
+    SVG2BITMAP="$1"
+else
+    SVG2BITMAP=$(ls "$TESTS_DIR"/../../../bin/*/*/sre/standalone/svg2bitmap 2>/dev/null | head -n 1)
+fi
+if [ ! -x "$SVG2BITMAP" ]; then
+    echo "svg2bitmap executable not found, please specify it on the command line" >&2
+    exit 1
+fi
+
+if command -v sha256sum >/dev/null 2>&1; then
+    SHA256="sha256sum"
+else
+    SHA256="shasum -a 256"
+fi
+
+WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/svg2bitmap-smoke.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIR"' EXIT
+RESULTS="$WORK_DIR/results.txt"
+: > "$RESULTS"
+FAILURES=0
+
+fail() {
+    echo "FAIL: $*" >&2
+    FAILURES=$((FAILURES + 1))
+}
+
+# record <case> <file>
+record() {
+    size=$(wc -c < "$2" | tr -d ' ')
+    sum=$($SHA256 < "$2" | cut -d ' ' -f 1)
+    echo "$1 $(basename "$2") $size $sum" >> "$RESULTS"
+}
+
+# run <case> <expected exit code> <svg2bitmap arguments...>
+# output files are written to $WORK_DIR/<case>, the printed report to $WORK_DIR/<case>.log
+run() {
+    name="$1"
+    expected="$2"
+    shift 2
+    mkdir -p "$WORK_DIR/$name"
+    # fixtures are referenced by relative paths, so that reports do not depend on the checkout location
+    (cd "$FIXTURES_DIR" && "$SVG2BITMAP" "$@" --output-path="$WORK_DIR/$name") > "$WORK_DIR/$name.log" 2>&1
+    code=$?
+    if [ $code -ne "$expected" ]; then
+        fail "$name exited with code $code (expected $expected)"
+        sed 's/^/    /' "$WORK_DIR/$name.log" >&2
+    fi
+}
+
+# report <case> <grep pattern>: record the report lines matching the given pattern
+report() {
+    grep -E "$2" "$WORK_DIR/$1.log" > "$WORK_DIR/$1.report"
+    record "$1" "$WORK_DIR/$1.report"
+}
+
+# pngs <case>: record all PNG files written by the given case
+pngs() {
+    for png in "$WORK_DIR/$1"/*.png; do
+        [ -f "$png" ] && record "$1" "$png"
+    done
+}
+
+# large document (1536 x 1536 pixels, high entropy content) for the PNG encoding round trip; it is generated
+# here, by a linear congruential generator, instead of being stored among fixtures
+awk 'BEGIN {
+    seed = 42;
+    print "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    print "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1536\" height=\"1536\" viewBox=\"0 0 384 384\" shape-rendering=\"crispEdges\">";
+    print "<linearGradient id=\"g\" x2=\"1\" y2=\"1\"><stop offset=\"0\" stop-color=\"#000\"/><stop offset=\"1\" stop-color=\"#FFF\"/></linearGradient>";
+    print "<rect width=\"384\" height=\"384\" fill=\"url(#g)\"/>";
+    for (y = 0; y < 384; y += 3) {
+        for (x = 0; x < 384; x += 3) {
+            seed = (seed * 1103515245 + 12345) % 2147483648;
+            printf("<rect x=\"%d\" y=\"%d\" width=\"3\" height=\"3\" fill=\"#%06X\" fill-opacity=\"0.%d\"/>", x, y, int(seed / 128) % 16777216, 1 + (seed % 9));
+        }
+        printf("\n");
+    }
+    print "</svg>";
+}' > "$WORK_DIR/large.svg"
+
+# number and length parsing (exponents, implicit separators, units, polyline/polygon points)
+run numbers 0 --input=numbers.svg --doc-stats
+report numbers "statistics|groups|gradients"
+pngs numbers
+
+# delimiter search: DOCTYPE, long comments, CDATA sections, quotes and delimiters inside attribute values
+run delimiters 0 --input=delimiters.svg --doc-stats --limits=100,100,1000,8
+report delimiters "statistics|groups|gradients"
+pngs delimiters
+
+# complexity limits, checked before parsing
+run limits 1 --input=numbers.svg --limits=0,0,16
+
+# gzip compressed documents: they must render exactly as the uncompressed ones
+mkdir -p "$WORK_DIR/svgz"
+gzip -9 -n -c "$FIXTURES_DIR/delimiters.svg" > "$WORK_DIR/svgz/delimiters.svgz"
+run gzip 0 --input="$WORK_DIR/svgz/delimiters.svgz"
+pngs gzip
+if ! cmp -s "$WORK_DIR/gzip/delimiters.png" "$WORK_DIR/delimiters/delimiters.png"; then
+    fail "gzip compressed document rendered differently"
+fi
+# multi-member gzip files are not supported, and they must be rejected
+mkdir -p "$WORK_DIR/multi"
+cat "$WORK_DIR/svgz/delimiters.svgz" "$WORK_DIR/svgz/delimiters.svgz" > "$WORK_DIR/multi/multi.svgz"
+run gzip-multi 1 --input="$WORK_DIR/multi/multi.svgz"
+# truncated data must be rejected too
+mkdir -p "$WORK_DIR/truncated"
+head -c 400 "$WORK_DIR/svgz/delimiters.svgz" > "$WORK_DIR/truncated/truncated.svgz"
+run gzip-truncated 1 --input="$WORK_DIR/truncated/truncated.svgz"
+
+# XML rewriting before parsing
+run theme 0 --input=theme.svg "--theme=red=#00AA00,currentColor=#202020,--accent=orange"
+report theme "themed"
+pngs theme
+run compact 0 --input=compact.svg --compact
+report compact "compacted"
+pngs compact
+run library 0 --input=library.svg --library=library/shapes.svg
+report library "loaded from|linked to"
+pngs library
+
+# element by element drawing
+run hide 0 --input=elements.svg --hide=sun "--hit-test=200,100"
+report hide "cover the region|hit-test|^    #"
+pngs hide
+run element 0 --input=elements.svg --element=house
+pngs element
+run draw-budget 0 --input=elements.svg --draw-budget=1
+pngs draw-budget
+run cost-report 0 --input=elements.svg --cost-report
+if [ ! -s "$WORK_DIR/cost-report/elements-heatmap.png" ]; then
+    fail "cost-report did not write the heatmap"
+fi
+# element by element drawing must match the plain one, also when the document is mapped at a fractional scale
+for scale in 1 1.37; do
+    for svg in elements numbers; do
+        run "plain-$svg-$scale" 0 --input=$svg.svg --scale=$scale
+        for mode in draw-budget=1 deadline=100000; do
+            run "${mode%=*}-$svg-$scale" 0 --input=$svg.svg --scale=$scale --$mode
+            if ! cmp -s "$WORK_DIR/plain-$svg-$scale/$svg.png" "$WORK_DIR/${mode%=*}-$svg-$scale/$svg.png"; then
+                fail "--${mode%=*} rendered $svg.svg differently from the plain drawing at scale $scale"
+            fi
+        done
+    done
+done
+if ! cmp -s "$WORK_DIR/cost-report/elements.png" "$WORK_DIR/plain-elements-1/elements.png"; then
+    fail "cost-report rendered differently from the plain drawing"
+fi
+run conflicting-modes 1 --input=elements.svg --cost-report --draw-budget=1
+
+# profiler zone hooks: zones must be balanced, in the plain, element by element and atlas modes
+run profile-check 0 --input=elements.svg --hide=sun --profile-check
+report profile-check "Profiler zones"
+run profile-check-atlas 0 --atlas-input=elements.svg,1,true --atlas-input=numbers.svg,1,false --atlas-output=atlas,json-array,array --profile-check
+report profile-check-atlas "Profiler zones"
+
+# PNG encoding round trip on a large image: the best and no compression must decode to the same pixels
+run large-best 0 --input="$WORK_DIR/large.svg" --compression-level=9 --memory-stats
+pngs large-best
+run large-store 0 --input="$WORK_DIR/large.svg" --compression-level=0
+if command -v python3 >/dev/null 2>&1; then
+    for level in best store; do
+        python3 - "$WORK_DIR/large-$level/large.png" > "$WORK_DIR/large-$level.pixels" <<'EOF' || fail "large-$level.png is not a valid PNG"
+import hashlib, struct, sys, zlib
+data = open(sys.argv[1], "rb").read()
+assert data[:8] == b"\x89PNG\r\n\x1a\n"
+pos, idat, width, height = 8, b"", 0, 0
+while pos < len(data):
+    length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+    body = data[pos + 8:pos + 8 + length]
+    assert struct.unpack(">I", data[pos + 8 + length:pos + 12 + length])[0] == zlib.crc32(kind + body) & 0xFFFFFFFF
+    if kind == b"IHDR":
+        width, height = struct.unpack(">II", body[:8])
+    elif kind == b"IDAT":
+        idat += body
+    pos += 12 + length
+assert kind == b"IEND"
+raw = zlib.decompress(idat)
+stride = 1 + width * 4
+assert (width, height) == (1536, 1536) and len(raw) == stride * height
+# the encoder writes unfiltered rows (filter type 0), so pixels are the rows without their filter byte
+assert all(raw[y * stride] == 0 for y in range(height))
+print(hashlib.sha256(b"".join(raw[y * stride + 1:(y + 1) * stride] for y in range(height))).hexdigest())
+EOF
+    done
+    if ! cmp -s "$WORK_DIR/large-best.pixels" "$WORK_DIR/large-store.pixels"; then
+        fail "large image pixels differ between compression levels"
+    fi
+else
+    echo "python3 not found, PNG round trip decoding skipped" >&2
+fi
+
+if [ $UPDATE -eq 1 ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "baseline updated ($(wc -l < "$BASELINE" | tr -d ' ') entries)"
+else
+    if ! diff -u "$BASELINE" "$RESULTS" >&2; then
+        fail "output differs from the baseline"
+    fi
+fi
+
+if [ $FAILURES -ne 0 ]; then
+    echo "$FAILURES failure(s)" >&2
+    exit 1
+fi
+echo "all smoke tests passed"
+exit 0
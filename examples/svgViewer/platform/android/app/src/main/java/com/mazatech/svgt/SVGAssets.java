@@ -418,6 +418,17 @@ public class SVGAssets {
     */
     public SVGDocument createDocument(String xmlText) {
 
+        return createDocument(xmlText, false);
+    }
+
+    /*
+        Create and load an SVG document, specifying the whole XML string.
+        If 'clonable' is true, the document retains a reference to the XML string, so that it can be
+        later passed to cloneDocument; otherwise no reference is kept.
+        If supplied XML string is null or empty, a null instance will be returned.
+    */
+    public SVGDocument createDocument(String xmlText, boolean clonable) {
+
         SVGDocument result = null;
 
         if (isInitialized()) {
@@ -433,7 +444,39 @@ public class SVGAssets {
                 SVGTHandle document = AmanithSVG.svgtDocCreate(xmlText);
                 // create SVGDocument instance out of handle
                 if (document != null) {
-                    result = new SVGDocument(document.getNativeHandle());
+                    result = new SVGDocument(document.getNativeHandle(), clonable ? xmlText : null);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /*
+        Create a new, independent, instance of the given document (e.g. to be owned by another thread).
+        The source document must have been created as clonable (see createDocument); the clone is created
+        from the same XML text (shared, not copied), it is clonable too, and it inherits the current
+        viewport and aspect ratio/alignment of the source document; it must be disposed separately.
+    */
+    public SVGDocument cloneDocument(SVGDocument src) {
+
+        SVGDocument result = null;
+
+        if (src == null) {
+            throw new IllegalArgumentException("src == null");
+        }
+        else
+        if (!src.isClonable()) {
+            throw new IllegalArgumentException("src is not clonable");
+        }
+        else {
+            // create the document out of the same XML text
+            if ((result = createDocument(src.getXmlText(), true)) != null) {
+                if ((src.getViewport() != null) && (result.getViewport() != null)) {
+                    result.setViewport(src.getViewport());
+                }
+                if (src.getAspectRatio() != null) {
+                    result.setAspectRatio(src.getAspectRatio());
                 }
             }
         }
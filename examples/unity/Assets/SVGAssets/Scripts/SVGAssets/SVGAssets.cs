@@ -61,6 +61,7 @@ using System;
 using System.Collections.Generic;
 using System.Collections.Concurrent;
 using System.Runtime.InteropServices;
+using System.Text;
 using System.Threading;
 
 namespace SVGAssets
@@ -738,6 +739,19 @@ namespace SVGAssets
         [DllImport(libName)]
         public static extern uint svgtDocCreate(string xmlText);
 
+        /*
+            Create and load an SVG document, specifying the whole xml as a zero-terminated
+            UTF-8 buffer.
+
+            The array is pinned and handed to the native parser as is, so a caller that
+            encodes the xml into a reusable buffer avoids the temporary copy that the
+            marshaler allocates for each string argument.
+
+            Return SVGT_INVALID_HANDLE in case of errors, else a valid document handle.
+        */
+        [DllImport(libName, EntryPoint = "svgtDocCreate")]
+        public static extern uint svgtDocCreate(byte[] xmlText);
+
         /*
             Destroy a previously created SVG document.
 
@@ -1685,7 +1699,8 @@ namespace SVGAssets
     public class SVGDocument : IDisposable
     {
         // Constructor.
-        internal SVGDocument(uint handle)
+        internal SVGDocument(uint handle,
+                             string xmlText)
         {
             uint err;
             float[] viewport = new float[4];
@@ -1693,6 +1708,9 @@ namespace SVGAssets
 
             // keep track of the AmanithSVG document handle
             Handle = handle;
+            // keep a reference to the source only if the document must be clonable (strings are
+            // immutable, so clones share it); otherwise the text can be collected right away
+            _xmlText = xmlText;
             _disposed = false;
 
             // get document viewport
@@ -1805,7 +1823,7 @@ namespace SVGAssets
             if ((surface != null) && (p != null))
             {
                 uint err;
-                float[] dst = new float[2];
+                float[] dst = s_pointMapDst ?? (s_pointMapDst = new float[2]);
 
                 // update document viewport (AmanithSVG backend)
                 if (UpdateViewport() != SVGError.None)
@@ -1833,10 +1851,144 @@ namespace SVGAssets
             }
         }
 
+        /*
+            Map an array of points (interleaved x, y pairs) from the document viewport system into the surface
+            viewport (inverse = false), or from the surface viewport into the document viewport system (inverse = true).
+            The combined viewport transformation is calculated once per call, so mapping many points costs three
+            native calls in total; 'src' and 'dst' can be the same array.
+        */
+        public SVGError PointMapBatch(SVGSurface surface,
+                                      float[] src,
+                                      float[] dst,
+                                      int count,
+                                      bool inverse)
+        {
+            SVGError err;
+            float[] m = s_pointMapMatrix ?? (s_pointMapMatrix = new float[6]);
+
+            if ((surface == null) || (src == null) || (dst == null) || (count < 0) || (src.Length < (count * 2)) || (dst.Length < (count * 2)))
+            {
+                return SVGError.IllegalArgument;
+            }
+            // calculate the combined viewport transformation
+            if ((err = PointMapMatrix(surface, inverse, m)) != SVGError.None)
+            {
+                return err;
+            }
+            // transform the whole array
+            for (int i = 0; i < (count * 2); i += 2)
+            {
+                float x = src[i];
+                float y = src[i + 1];
+                dst[i] = (m[0] * x) + (m[2] * y) + m[4];
+                dst[i + 1] = (m[1] * x) + (m[3] * y) + m[5];
+            }
+
+            return SVGError.None;
+        }
+
+        /*
+            Calculate the affine matrix (a, b, c, d, tx, ty) that maps document points into surface points, or vice versa.
+            The matrix is built from the viewports in double precision: sampling svgtPointMap and differencing the results
+            would lose all precision when the document viewport origin is far from zero.
+        */
+        private SVGError PointMapMatrix(SVGSurface surface,
+                                        bool inverse,
+                                        float[] m)
+        {
+            uint err;
+            float[] docViewport = new float[4];
+            float[] surfaceViewport = new float[4];
+            uint[] alignment = new uint[2];
+
+            // update document viewport (AmanithSVG backend)
+            if (UpdateViewport() != SVGError.None)
+            {
+                return SVGError.IllegalArgument;
+            }
+            // update surface viewport (AmanithSVG backend)
+            if (surface.UpdateViewport() != SVGError.None)
+            {
+                return SVGError.IllegalArgument;
+            }
+            if (((err = AmanithSVG.svgtDocViewportGet(Handle, docViewport)) != AmanithSVG.SVGT_NO_ERROR) ||
+                ((err = AmanithSVG.svgtDocViewportAlignmentGet(Handle, alignment)) != AmanithSVG.SVGT_NO_ERROR) ||
+                ((err = AmanithSVG.svgtSurfaceViewportGet(surface.Handle, surfaceViewport)) != AmanithSVG.SVGT_NO_ERROR))
+            {
+                // log an error message
+                SVGAssets.LogError("SVGDocument::PointMapBatch getting viewports failed", (SVGError)err);
+                return (SVGError)err;
+            }
+            if ((docViewport[2] <= 0.0f) || (docViewport[3] <= 0.0f) || (surfaceViewport[2] <= 0.0f) || (surfaceViewport[3] <= 0.0f))
+            {
+                // degenerate viewport
+                return SVGError.IllegalArgument;
+            }
+            else
+            {
+                double sx = (double)surfaceViewport[2] / (double)docViewport[2];
+                double sy = (double)surfaceViewport[3] / (double)docViewport[3];
+                double offsetX = 0.0;
+                double offsetY = 0.0;
+                double tx, ty;
+
+                if (alignment[0] != AmanithSVG.SVGT_ASPECT_RATIO_ALIGN_NONE)
+                {
+                    // uniform scale; alignments are ordered as xMin, xMid, xMax within yMin, yMid, yMax
+                    double s = (alignment[1] == AmanithSVG.SVGT_ASPECT_RATIO_SLICE) ? Math.Max(sx, sy) : Math.Min(sx, sy);
+                    double alignX = ((alignment[0] - 1) % 3) * 0.5;
+                    double alignY = ((alignment[0] - 1) / 3) * 0.5;
+                    offsetX = ((double)surfaceViewport[2] - ((double)docViewport[2] * s)) * alignX;
+                    offsetY = ((double)surfaceViewport[3] - ((double)docViewport[3] * s)) * alignY;
+                    sx = s;
+                    sy = s;
+                }
+                // the document viewport origin is mapped onto the (aligned) surface viewport origin
+                tx = (double)surfaceViewport[0] + offsetX - ((double)docViewport[0] * sx);
+                ty = (double)surfaceViewport[1] + offsetY - ((double)docViewport[1] * sy);
+
+                m[1] = 0.0f;
+                m[2] = 0.0f;
+                if (inverse)
+                {
+                    m[0] = (float)(1.0 / sx);
+                    m[3] = (float)(1.0 / sy);
+                    m[4] = (float)(-tx / sx);
+                    m[5] = (float)(-ty / sy);
+                }
+                else
+                {
+                    m[0] = (float)sx;
+                    m[3] = (float)sy;
+                    m[4] = (float)tx;
+                    m[5] = (float)ty;
+                }
+            }
+
+            return SVGError.None;
+        }
 
         // AmanithSVG document handle (read only).
         public uint Handle { get; protected set; } = AmanithSVG.SVGT_INVALID_HANDLE;
 
+        // True if the document has been created as clonable (i.e. it retains its source XML text), see SVGAssets.CloneDocument.
+        public bool Clonable
+        {
+            get
+            {
+                return (_xmlText != null);
+            }
+        }
+
+        // Source XML text (retained for clonable documents only, null otherwise).
+        internal string XmlText
+        {
+            get
+            {
+                return _xmlText;
+            }
+        }
+
         /*
             SVG content itself optionally can provide information about the appropriate viewport region for
             the content via the 'width' and 'height' XML attributes on the outermost <svg> element.
@@ -1919,10 +2071,18 @@ namespace SVGAssets
 
         // Track whether Dispose has been called.
         private bool _disposed;
+        // Source XML text (null if the document is not clonable).
+        private string _xmlText;
         // Viewport.
         private SVGViewport _viewport;
         // Viewport aspect ratio/alignment.
         private SVGAspectRatio _aspectRatio;
+        // Point mapping scratch buffers (reused across calls, in order to avoid allocations); each thread owns its
+        // own buffers, so that points can be mapped concurrently from different threads.
+        [ThreadStatic]
+        private static float[] s_pointMapDst;
+        [ThreadStatic]
+        private static float[] s_pointMapMatrix;
     }
 
     /*
@@ -3154,6 +3314,18 @@ namespace SVGAssets
             If supplied XML string is null or empty, a null instance will be returned.
         */
         internal static SVGDocument CreateDocument(string xmlText)
+        {
+            return CreateDocument(xmlText, false);
+        }
+
+        /*
+            Create and load an SVG document, specifying the whole XML string.
+            If 'clonable' is true, the document retains a reference to the XML string, so that it can be
+            later passed to CloneDocument; otherwise no reference is kept.
+            If supplied XML string is null or empty, a null instance will be returned.
+        */
+        internal static SVGDocument CreateDocument(string xmlText,
+                                                   bool clonable)
         {
             SVGDocument result = null;
 
@@ -3162,14 +3334,100 @@ namespace SVGAssets
                 // ensure that per-thread data structures needed by AmanithSVG are assigned
                 ThreadDataEnsure();
 
-                // create the document
-                uint handle = AmanithSVG.svgtDocCreate(xmlText);
-                result = (handle != AmanithSVG.SVGT_INVALID_HANDLE) ? (new SVGDocument(handle)) : null;
+                // create the document, passing the xml through the per-thread UTF-8 buffer
+                uint handle = AmanithSVG.svgtDocCreate(XmlBufferEncode(xmlText));
+                // AmanithSVG does not keep a reference to the passed text, so an oversized buffer can be dropped now
+                XmlBufferTrim();
+                result = (handle != AmanithSVG.SVGT_INVALID_HANDLE) ? (new SVGDocument(handle, clonable ? xmlText : null)) : null;
             }
 
             return result;
         }
 
+        /*
+            Create a new, independent, instance of the given document (e.g. to be owned by another thread).
+            The source document must have been created as clonable (see CreateDocument); the clone is created
+            from the same XML text (shared, not copied), it is clonable too, and it inherits the current
+            viewport and aspect ratio/alignment of the source document; it must be disposed separately.
+            If the clone cannot be created, a null instance will be returned.
+        */
+        internal static SVGDocument CloneDocument(SVGDocument src)
+        {
+            SVGDocument result = null;
+
+            if ((src != null) && src.Clonable)
+            {
+                if ((result = CreateDocument(src.XmlText, true)) != null)
+                {
+                    if (src.Viewport != null)
+                    {
+                        result.Viewport = new SVGViewport(src.Viewport.X, src.Viewport.Y, src.Viewport.Width, src.Viewport.Height);
+                    }
+                    if (src.AspectRatio != null)
+                    {
+                        result.AspectRatio = new SVGAspectRatio(src.AspectRatio.Alignment, src.AspectRatio.MeetOrSlice);
+                    }
+                }
+                else
+                {
+                    // log an error message
+                    LogError("SVGAssets::CloneDocument creating the document failed");
+                }
+            }
+            else
+            {
+                // log an error message
+                LogError("SVGAssets::CloneDocument source document is null or not clonable");
+            }
+
+            return result;
+        }
+
+        /*
+            Encode the given XML string into the UTF-8 buffer of the calling thread, appending
+            the '\0' terminator expected by AmanithSVG.
+
+            The buffer is reused across loads and it is enlarged only when a bigger document
+            comes in; buffers larger than XML_BUFFER_MAX_RETAINED bytes are released after use
+            (see XmlBufferTrim), so that a single huge document does not pin its memory for the
+            whole thread lifetime.
+
+            Only the allocation is saved: GetByteCount and GetBytes still perform a full pass
+            over the string each, to measure and to transcode it from UTF-16 to UTF-8.
+        */
+        private static byte[] XmlBufferEncode(string xmlText)
+        {
+            int length = Encoding.UTF8.GetByteCount(xmlText);
+
+            if ((s_xmlBuffer == null) || (s_xmlBuffer.Length <= length))
+            {
+                int capacity = (s_xmlBuffer != null) ? s_xmlBuffer.Length : 4096;
+                // grow geometrically, so that a sequence of increasing documents does not reallocate each time
+                while (capacity <= length)
+                {
+                    capacity = (capacity <= (int.MaxValue / 2)) ? (capacity * 2) : int.MaxValue;
+                }
+                s_xmlBuffer = new byte[capacity];
+            }
+
+            // encode in place, then terminate the string
+            length = Encoding.UTF8.GetBytes(xmlText, 0, xmlText.Length, s_xmlBuffer, 0);
+            s_xmlBuffer[length] = 0;
+            return s_xmlBuffer;
+        }
+
+        /*
+            Release the UTF-8 buffer of the calling thread, if it is larger than XML_BUFFER_MAX_RETAINED
+            bytes; it must be called once AmanithSVG has consumed the buffer.
+        */
+        private static void XmlBufferTrim()
+        {
+            if ((s_xmlBuffer != null) && (s_xmlBuffer.Length > XML_BUFFER_MAX_RETAINED))
+            {
+                s_xmlBuffer = null;
+            }
+        }
+
         /*
             Create an SVG packer, specifying a scale factor.
 
@@ -3230,5 +3488,15 @@ namespace SVGAssets
         private static ConcurrentDictionary<int, IntPtr> s_logBuffers = null;
         /* The configuration with which the class was initialized. */
         private static SVGAssetsConfig s_initConfig = null;
+        /*
+            UTF-8 encoding buffer used to pass XML strings to AmanithSVG.
+
+            Each thread owns its own buffer, so that documents can be created
+            concurrently from different threads.
+        */
+        [ThreadStatic]
+        private static byte[] s_xmlBuffer;
+        // Maximum size of the UTF-8 encoding buffer kept by each thread, in bytes.
+        private const int XML_BUFFER_MAX_RETAINED = 1024 * 1024;
     }
 }
@@ -753,6 +753,45 @@ namespace SVGAssets
             return SVGAssets.CreateDocument(xmlText);
         }
 
+        /*
+            Create and load an SVG document, specifying the whole XML string.
+            If supplied XML string is null or empty, a null instance will be returned.
+
+            If 'clonable' is true, the document retains a reference to the XML string, so that it can be
+            later passed to CloneDocument; otherwise no reference is kept.
+        */
+        public static SVGDocument CreateDocument(string xmlText,
+                                                 bool clonable)
+        {
+            // initialize AmanithSVG, if needed
+            if (!IsInitialized())
+            {
+                Init();
+            }
+
+            // create the document
+            return SVGAssets.CreateDocument(xmlText, clonable);
+        }
+
+        /*
+            Create a new document out of the given one, without keeping a second copy of the XML text.
+
+            The source document must have been created as clonable (see CreateDocument), else a null
+            instance will be returned; the clone is clonable too, and it inherits the current viewport
+            and alignment of the source document.
+        */
+        public static SVGDocument CloneDocument(SVGDocument src)
+        {
+            // initialize AmanithSVG, if needed
+            if (!IsInitialized())
+            {
+                Init();
+            }
+
+            // clone the document
+            return SVGAssets.CloneDocument(src);
+        }
+
         /*
             Create an SVG packer, specifying a scale factor.
 